@@ -0,0 +1,449 @@
+#ifndef LEPTO_BROADCAST_RING_HPP
+#define LEPTO_BROADCAST_RING_HPP
+/**---------------------------------------------------------------------------
+ *
+ * @file    broadcastRing.hpp
+ * @brief   Ring buffer with one writer and many independent readers
+ *
+ * The writer pushes every entry once; each reader has its own cursor and
+ * sees the whole stream from the moment it attached. Entries are read in
+ * place, nothing is copied per reader.
+ *
+ * What happens when the writer catches up with a reader is chosen by the
+ * policy:
+ *    EBroadcastPolicy::Block      push_back() fails as long as the slowest
+ *                                 reader would lose an entry
+ *    EBroadcastPolicy::Overwrite  the writer never waits; readers that were
+ *                                 lapped skip the lost entries and count them
+ *                                 as overruns
+ *
+ * With Overwrite every slot is a sequence lock like in CLossyRing. An entry
+ * read in place may change while it is processed; dropFront() tells
+ * afterwards if it did. pop() copies and only returns intact entries.
+ * Entries have to be trivially copyable then.
+ *
+ * The number of readers is limited by the constructor. The capacity has to
+ * be a power of two. Readers attach and detach at any time from any thread.
+ *
+ * Example:
+ *    CBroadcastRing<SFrame> frames( 64, 4 );
+ *    CBroadcastRing<SFrame>::CReader logger( frames );
+ *    CBroadcastRing<SFrame>::CReader display( frames );
+ *
+ *    frames << frame;                                // Writer thread
+ *
+ *    while( const SFrame* frame=logger.frontEntry() )    // Reader thread
+ *    {
+ *       log( *frame );
+ *       logger.dropFront();
+ *    }
+ *
+ * @date   20261017
+ * @author Maximilian Seesslen <src@seesslen.net>
+ * @copyright SPDX-License-Identifier: Apache-2.0
+ *
+ *--------------------------------------------------------------------------*/
+
+
+/*--- Includes -------------------------------------------------------------*/
+
+
+#include <lepto/list.hpp>        // ringIndex_t, configs
+#include <lepto/lossyRing.hpp>   // relaxedCopy
+
+
+/*--- Definitions ----------------------------------------------------------*/
+
+
+/**
+ * @brief What the writer of a CBroadcastRing does when a reader lags a
+ *        whole lap behind
+ */
+enum class EBroadcastPolicy
+{
+   Block,         ///< Wait for the slowest reader; push_back() fails
+   Overwrite,     ///< Overwrite; the reader counts overruns
+};
+
+
+template <typename T, EBroadcastPolicy POLICY = EBroadcastPolicy::Block>
+class CBroadcastRing
+{
+   static_assert( ( POLICY == EBroadcastPolicy::Block ) || __is_trivially_copyable( T ),
+                  "Entries may change while being read" );
+
+   private:
+      struct SSlot
+      {
+         ringIndex_t stamp;            // Overwrite only
+         T data;
+      };
+
+      struct SCursor
+      {
+         LEPTO_RING_CACHELINE_ALIGNED ringIndex_t pos;
+         int attached;
+         ringIndex_t stamp;            // Seen by frontEntry()
+         unsigned int overruns;
+      };
+
+      SSlot* m_slots;
+      ringIndex_t m_mask;
+      SCursor* m_cursors;
+      int m_maxReaders;
+      LEPTO_RING_CACHELINE_ALIGNED ringIndex_t m_backPos;
+      ringIndex_t m_slowest;           // Writer only; cached slowest cursor
+
+      static int diff( ringIndex_t a, ringIndex_t b )
+      {
+         return( (int)( a - b ) );
+      }
+
+      static ringIndex_t published( ringIndex_t pos )
+      {
+         return( 2 * pos + 2 );
+      }
+
+      /**
+       * @brief Position of the slowest reader; 'back' without readers
+       */
+      ringIndex_t slowest( ringIndex_t back ) const
+      {
+         ringIndex_t pos=back;
+
+         for( int i1=0; i1 < m_maxReaders; i1++ )
+         {
+            const SCursor& cursor=m_cursors[i1];
+            if( __atomic_load_n( &cursor.attached, __ATOMIC_SEQ_CST ) )
+            {
+               ringIndex_t readerPos=__atomic_load_n( &cursor.pos, __ATOMIC_SEQ_CST );
+               pos=( diff( readerPos, pos ) < 0 ) ? readerPos : pos;
+            }
+         }
+
+         return( pos );
+      }
+
+   public:
+      class CReader;
+
+      /**
+       * @param maxEntries: Capacity; a power of two
+       * @param maxReaders: Number of readers that can be attached at once
+       */
+      CBroadcastRing( int maxEntries, int maxReaders )
+         :m_slots( new SSlot[ maxEntries ] )
+         ,m_mask( maxEntries - 1 )
+         ,m_cursors( new SCursor[ maxReaders ] )
+         ,m_maxReaders( maxReaders )
+         ,m_backPos( 0 )
+         ,m_slowest( 0 )
+      {
+         lAssert( maxEntries && ( ( maxEntries & ( maxEntries - 1 ) ) == 0 ) );
+         for( int i1=0; i1<maxEntries; i1++ )
+         {
+            // Published one lap before position 0
+            m_slots[i1].stamp=published( i1 - maxEntries );
+         }
+         for( int i1=0; i1<maxReaders; i1++ )
+         {
+            m_cursors[i1].pos=0;
+            m_cursors[i1].attached=0;
+            m_cursors[i1].stamp=0;
+            m_cursors[i1].overruns=0;
+         }
+      }
+
+      ~CBroadcastRing()
+      {
+         delete[] m_slots;
+         delete[] m_cursors;
+      }
+
+      CBroadcastRing( const CBroadcastRing& ) = delete;
+      CBroadcastRing& operator=( const CBroadcastRing& ) = delete;
+
+      int getMaxEntries() const
+      {
+         return( m_mask + 1 );
+      }
+
+      int getMaxReaders() const
+      {
+         return( m_maxReaders );
+      }
+
+      //--- Writer side; one thread only ------------------------------------
+
+      /**
+       * @brief   Push an entry for all readers
+       * @return  false if the ring is full for the slowest reader (Block)
+       */
+      bool push_back( const T& value )
+      {
+         ringIndex_t back=m_backPos;
+         SSlot& slot=m_slots[ back & m_mask ];
+
+         if( POLICY == EBroadcastPolicy::Block )
+         {
+            // The readers only move forward; look at them again only when
+            // the cached position is a lap behind
+            if( diff( back, m_slowest ) >= getMaxEntries() )
+            {
+               m_slowest=slowest( back );
+               if( diff( back, m_slowest ) >= getMaxEntries() )
+               {
+                  return( false );
+               }
+            }
+            slot.data=value;
+         }
+         else
+         {
+            __atomic_store_n( &slot.stamp, published( back ) - 1, __ATOMIC_RELAXED );
+            __atomic_thread_fence( __ATOMIC_RELEASE );
+            relaxedCopy<T>( &slot.data, &value );
+            __atomic_store_n( &slot.stamp, published( back ), __ATOMIC_RELEASE );
+         }
+         __atomic_store_n( &m_backPos, back + 1, __ATOMIC_SEQ_CST );
+
+         return( true );
+      }
+
+      CBroadcastRing& operator << ( const T& value )
+      {
+         push_back( value );
+         return( *this );
+      }
+
+      /**
+       * @brief  Number of attached readers
+       */
+      int getReaders() const
+      {
+         int readers=0;
+
+         for( int i1=0; i1 < m_maxReaders; i1++ )
+         {
+            readers+=__atomic_load_n( &m_cursors[i1].attached, __ATOMIC_RELAXED );
+         }
+
+         return( readers );
+      }
+
+      /**
+       * @brief  Entries the slowest reader is behind the writer
+       */
+      int getMaxLag() const
+      {
+         ringIndex_t back=__atomic_load_n( &m_backPos, __ATOMIC_SEQ_CST );
+         return( MIN( diff( back, slowest( back ) ), getMaxEntries() ) );
+      }
+
+      //--- Reader side -----------------------------------------------------
+
+      /**
+       * @brief Cursor of one reader. Attaches on construction and detaches
+       *        on destruction. Every reader is used by one thread.
+       */
+      class CReader
+      {
+         private:
+            CBroadcastRing& m_ring;
+            SCursor* m_cursor;
+
+         public:
+            CReader( CBroadcastRing& ring )
+               :m_ring( ring )
+               ,m_cursor( nullptr )
+            {
+               attach();
+            }
+
+            ~CReader()
+            {
+               detach();
+            }
+
+            CReader( const CReader& ) = delete;
+            CReader& operator=( const CReader& ) = delete;
+
+            /**
+             * @brief Start reading with the next entry pushed
+             * @return false if 'maxReaders' readers are attached already
+             */
+            bool attach()
+            {
+               if( m_cursor )
+               {
+                  return( true );
+               }
+               for( int i1=0; i1 < m_ring.m_maxReaders; i1++ )
+               {
+                  SCursor& cursor=m_ring.m_cursors[i1];
+                  int detached=0;
+
+                  if( __atomic_compare_exchange_n( &cursor.attached, &detached, 1, false,
+                                                   __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST ) )
+                  {
+                     // Until the writer sees the new position it sees the
+                     // older one of the previous reader; it may only wait
+                     // longer than necessary
+                     __atomic_store_n( &cursor.pos, __atomic_load_n( &m_ring.m_backPos, __ATOMIC_SEQ_CST ),
+                                       __ATOMIC_SEQ_CST );
+                     __atomic_store_n( &cursor.overruns, 0, __ATOMIC_RELAXED );
+                     m_cursor=&cursor;
+                     return( true );
+                  }
+               }
+               return( false );
+            }
+
+            void detach()
+            {
+               if( m_cursor )
+               {
+                  __atomic_store_n( &m_cursor->attached, 0, __ATOMIC_SEQ_CST );
+                  m_cursor=nullptr;
+               }
+            }
+
+            bool isAttached() const
+            {
+               return( m_cursor != nullptr );
+            }
+
+            /**
+             * @brief  Number of entries pushed but not read by this reader
+             */
+            int lag() const
+            {
+               if( !m_cursor )
+               {
+                  return( 0 );
+               }
+               return( MIN( diff( __atomic_load_n( &m_ring.m_backPos, __ATOMIC_ACQUIRE ),
+                                  m_cursor->pos ), m_ring.getMaxEntries() ) );
+            }
+
+            /**
+             * @brief  Entries this reader lost because the writer overwrote
+             *         them (Overwrite only). Can be read from any thread.
+             */
+            unsigned int getOverruns() const
+            {
+               return( m_cursor ? __atomic_load_n( &m_cursor->overruns, __ATOMIC_RELAXED ) : 0 );
+            }
+
+            bool isDataAvailable() const
+            {
+               return( lag() > 0 );
+            }
+
+            /**
+             * @brief  Entry to read in place; nullptr if there is none
+             */
+            const T* frontEntry()
+            {
+               if( !m_cursor )
+               {
+                  return( nullptr );
+               }
+
+               while( true )
+               {
+                  ringIndex_t back=__atomic_load_n( &m_ring.m_backPos, __ATOMIC_ACQUIRE );
+                  ringIndex_t pos=m_cursor->pos;
+
+                  if( pos == back )
+                  {
+                     return( nullptr );
+                  }
+
+                  const SSlot& slot=m_ring.m_slots[ pos & m_ring.m_mask ];
+                  if( POLICY == EBroadcastPolicy::Block )
+                  {
+                     return( &slot.data );
+                  }
+
+                  if( diff( back, pos ) > m_ring.getMaxEntries() )
+                  {
+                     // Lapped by the writer
+                     skip( back - m_ring.getMaxEntries() - pos );
+                     continue;
+                  }
+                  m_cursor->stamp=__atomic_load_n( &slot.stamp, __ATOMIC_ACQUIRE );
+                  if( m_cursor->stamp == published( pos ) )
+                  {
+                     return( &slot.data );
+                  }
+                  // Overwritten meanwhile
+                  skip( 1 );
+               }
+            }
+
+            /**
+             * @brief  Done with the entry of frontEntry()
+             * @return false if the entry was overwritten while being read
+             *         (Overwrite only); it counts as overrun then
+             */
+            bool dropFront()
+            {
+               lAssert( m_cursor );
+               ringIndex_t pos=m_cursor->pos;
+
+               lAssert( pos != __atomic_load_n( &m_ring.m_backPos, __ATOMIC_RELAXED ) );
+               if( POLICY == EBroadcastPolicy::Overwrite )
+               {
+                  const SSlot& slot=m_ring.m_slots[ pos & m_ring.m_mask ];
+                  __atomic_thread_fence( __ATOMIC_ACQUIRE );
+                  if( __atomic_load_n( &slot.stamp, __ATOMIC_RELAXED ) != m_cursor->stamp )
+                  {
+                     skip( 1 );
+                     return( false );
+                  }
+               }
+               // The writer may reuse the slot afterwards
+               __atomic_store_n( &m_cursor->pos, pos + 1, __ATOMIC_SEQ_CST );
+
+               return( true );
+            }
+
+            /**
+             * @brief  Copy the next intact entry into 'value'
+             * @return false if there is none
+             */
+            bool pop( T& value )
+            {
+               while( const T* entry=frontEntry() )
+               {
+                  if( POLICY == EBroadcastPolicy::Block )
+                  {
+                     value=*entry;
+                     dropFront();
+                     return( true );
+                  }
+
+                  alignas( T ) unsigned char buffer[ sizeof( T ) ];
+                  relaxedCopy<T>( buffer, entry );
+                  if( dropFront() )
+                  {
+                     memcpy( (void*)&value, buffer, sizeof( T ) );
+                     return( true );
+                  }
+               }
+               return( false );
+            }
+
+         private:
+            void skip( unsigned int entries )
+            {
+               __atomic_add_fetch( &m_cursor->overruns, entries, __ATOMIC_RELAXED );
+               __atomic_store_n( &m_cursor->pos, m_cursor->pos + entries, __ATOMIC_SEQ_CST );
+            }
+      };
+};
+
+
+/*--- Fin ------------------------------------------------------------------*/
+#endif // ? ! LEPTO_BROADCAST_RING_HPP
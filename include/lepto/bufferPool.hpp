@@ -0,0 +1,454 @@
+#ifndef LEPTO_BUFFER_POOL_HPP
+#define LEPTO_BUFFER_POOL_HPP
+/**---------------------------------------------------------------------------
+ *
+ * @file    bufferPool.hpp
+ * @brief   Pool of fixed-size buffers; lock-free acquire and release
+ *
+ * Like CBufferRing, all buffers are carved from one aligned arena which is
+ * allocated once in the constructor. Unlike the ring, buffers are handed
+ * out and given back in any order, from any thread. No malloc/free per
+ * packet.
+ *
+ * The free buffers form a stack of indices (Treiber stack). Its head holds
+ * a tag which is incremented by every change, so a head that was popped
+ * and pushed again in between (ABA) fails the CAS. The tag has 32 bits
+ * where 64 bit atomics are lock-free and 16 bits otherwise; then at most
+ * 65535 buffers are possible.
+ *
+ * Every buffer has a reference count. CBufferHandle counts it up and down
+ * by copying and destroying; the last reference gives the buffer back.
+ * Rings can carry the plain index instead: CBufferHandle::detach() keeps
+ * the reference for the index and CBufferPool::adopt() turns it into a
+ * handle again.
+ *
+ * Example:
+ *    CBufferPool pool( 1536, 64 );
+ *    CSpscRing<int> packets( 64 );
+ *
+ *    CBufferHandle packet=pool.acquire();          // Any thread
+ *    if( packet )
+ *    {
+ *       receive( packet.data(), packet.size() );
+ *       packets.push_back( packet.detach() );
+ *    }
+ *
+ *    CBufferHandle packet=pool.adopt( packets.pop() );
+ *
+ * @date   20261017
+ * @author Maximilian Seesslen <src@seesslen.net>
+ * @copyright SPDX-License-Identifier: Apache-2.0
+ *
+ *--------------------------------------------------------------------------*/
+
+
+/*--- Includes -------------------------------------------------------------*/
+
+
+#include <lepto/lepto.h>            // CONFIG_LEPTO_CACHELINE_SIZE
+#include <lepto/log.h>              // lAssert
+#include <lepto/tuple.hpp>          // doMove
+#include <lepto/memoryResource.hpp>
+
+
+/*--- Definitions ----------------------------------------------------------*/
+
+
+class CBufferPool;
+
+
+/**
+ * @brief Counted reference to a buffer of a CBufferPool
+ */
+class CBufferHandle
+{
+   private:
+      CBufferPool* m_pool;
+      int m_index;
+
+      friend class CBufferPool;
+
+      // Takes over a reference which is already counted
+      CBufferHandle( CBufferPool* pool, int index )
+         :m_pool( pool )
+         ,m_index( index )
+      {
+      }
+
+   public:
+      CBufferHandle()
+         :m_pool( nullptr )
+         ,m_index( -1 )
+      {
+      }
+
+      inline CBufferHandle( const CBufferHandle& other );
+      CBufferHandle( CBufferHandle&& other )
+         :m_pool( other.m_pool )
+         ,m_index( other.m_index )
+      {
+         other.m_pool=nullptr;
+         other.m_index=-1;
+      }
+
+      ~CBufferHandle()
+      {
+         reset();
+      }
+
+      CBufferHandle& operator=( const CBufferHandle& other )
+      {
+         CBufferHandle copy( other );
+         return( *this=doMove( copy ) );
+      }
+
+      CBufferHandle& operator=( CBufferHandle&& other )
+      {
+         if( this != &other )
+         {
+            reset();
+            m_pool=other.m_pool;
+            m_index=other.m_index;
+            other.m_pool=nullptr;
+            other.m_index=-1;
+         }
+         return( *this );
+      }
+
+      explicit operator bool() const
+      {
+         return( m_pool != nullptr );
+      }
+
+      int index() const
+      {
+         return( m_index );
+      }
+
+      inline void* data() const;
+      inline int size() const;
+      inline int getRefCount() const;
+
+      /**
+       * @brief Drop the reference; the handle is empty afterwards
+       */
+      inline void reset();
+
+      /**
+       * @brief  Hand the reference over to the caller, e.g. to pass it
+       *         through a ring. The handle is empty afterwards.
+       * @return Index of the buffer; -1 for an empty handle
+       */
+      int detach()
+      {
+         int index=m_index;
+
+         m_pool=nullptr;
+         m_index=-1;
+
+         return( index );
+      }
+};
+
+
+class CBufferPool
+{
+   private:
+#if __GCC_ATOMIC_LLONG_LOCK_FREE == 2
+      typedef unsigned long long head_t;
+      static constexpr int INDEX_BITS = 32;
+#else
+      typedef unsigned int head_t;
+      static constexpr int INDEX_BITS = 16;
+#endif
+      static constexpr head_t INDEX_MASK = ( (head_t)1 << INDEX_BITS ) - 1;
+      static constexpr unsigned int NONE = (unsigned int)INDEX_MASK;
+
+      struct SSlot
+      {
+         unsigned int next;
+         int refs;
+      };
+
+      CMemoryResource* m_resource;
+      int m_bufferSize;
+      int m_buffers;
+      size_t m_alignment;
+      size_t m_stride;
+      char* m_arena;
+      SSlot* m_slots;
+      // Contended by all threads; kept apart from the rest
+      alignas( CONFIG_LEPTO_CACHELINE_SIZE ) head_t m_head;
+      alignas( CONFIG_LEPTO_CACHELINE_SIZE ) int m_used;
+      int m_highWater;
+      unsigned int m_exhausted;
+
+      static unsigned int indexOf( head_t head )
+      {
+         return( (unsigned int)( head & INDEX_MASK ) );
+      }
+
+      static head_t nextHead( head_t head, unsigned int index )
+      {
+         // Tag in the upper bits
+         return( ( ( head & ~INDEX_MASK ) + ( INDEX_MASK + 1 ) ) | index );
+      }
+
+      void pushFree( unsigned int index )
+      {
+         head_t head=__atomic_load_n( &m_head, __ATOMIC_RELAXED );
+
+         do
+         {
+            __atomic_store_n( &m_slots[ index ].next, indexOf( head ), __ATOMIC_RELAXED );
+         } while( ! __atomic_compare_exchange_n( &m_head, &head, nextHead( head, index ),
+                     true, __ATOMIC_RELEASE, __ATOMIC_RELAXED ) );
+      }
+
+      unsigned int popFree()
+      {
+         head_t head=__atomic_load_n( &m_head, __ATOMIC_ACQUIRE );
+         unsigned int index;
+
+         do
+         {
+            index=indexOf( head );
+            if( index == NONE )
+            {
+               return( NONE );
+            }
+            // May be stale; the CAS fails then
+         } while( ! __atomic_compare_exchange_n( &m_head, &head,
+                     nextHead( head, __atomic_load_n( &m_slots[ index ].next, __ATOMIC_RELAXED ) ),
+                     true, __ATOMIC_ACQUIRE, __ATOMIC_ACQUIRE ) );
+
+         return( index );
+      }
+
+   public:
+
+      /**
+       * @param resource: Memory for the arena and the bookkeeping; nullptr
+       *        for global new/delete
+       * @param alignment: Alignment of every buffer; a power of two
+       */
+      CBufferPool( int bufferSize, int buffers, CMemoryResource* resource = nullptr,
+                   size_t alignment = alignof( max_align_t ) )
+         :m_resource( resource )
+         ,m_bufferSize( bufferSize )
+         ,m_buffers( buffers )
+         ,m_alignment( alignment )
+         ,m_stride( leptoStride( bufferSize, alignment ) )
+         ,m_head( NONE )
+         ,m_used( 0 )
+         ,m_highWater( 0 )
+         ,m_exhausted( 0 )
+      {
+         lAssert( ( buffers > 0 ) && ( (unsigned int)buffers < NONE ) );
+
+         m_slots=(SSlot*)leptoAllocate( m_resource, buffers * sizeof( SSlot ), alignof( SSlot ) );
+         m_arena=(char*)leptoAllocate( m_resource, getArenaSize(), m_alignment );
+         lFullAssert( m_slots && m_arena );
+
+         // Lowest index on top
+         for( int i1=buffers - 1; i1 >= 0; i1-- )
+         {
+            m_slots[i1].refs=0;
+            m_slots[i1].next=indexOf( m_head );
+            m_head=i1;
+         }
+      }
+
+      ~CBufferPool()
+      {
+         lDebugAssert( m_used == 0 );
+         // Reverse order for stacking resources
+         leptoDeallocate( m_resource, m_arena, getArenaSize(), m_alignment );
+         leptoDeallocate( m_resource, m_slots, m_buffers * sizeof( SSlot ), alignof( SSlot ) );
+         m_arena=nullptr;
+         m_slots=nullptr;
+      }
+
+      CBufferPool( const CBufferPool& ) = delete;
+      CBufferPool& operator=( const CBufferPool& ) = delete;
+
+      //--- Index API; thread safe ------------------------------------------
+
+      /**
+       * @brief  Take a free buffer with a reference count of 1
+       * @return Index of the buffer; -1 if the pool is exhausted
+       */
+      int acquireIndex()
+      {
+         unsigned int index=popFree();
+
+         if( index == NONE )
+         {
+            __atomic_add_fetch( &m_exhausted, 1, __ATOMIC_RELAXED );
+            return( -1 );
+         }
+         __atomic_store_n( &m_slots[ index ].refs, 1, __ATOMIC_RELAXED );
+
+         int used=__atomic_add_fetch( &m_used, 1, __ATOMIC_RELAXED );
+         int highWater=__atomic_load_n( &m_highWater, __ATOMIC_RELAXED );
+         while( ( used > highWater )
+                && ! __atomic_compare_exchange_n( &m_highWater, &highWater, used,
+                        true, __ATOMIC_RELAXED, __ATOMIC_RELAXED ) )
+         {
+         }
+
+         return( (int)index );
+      }
+
+      void retain( int index )
+      {
+         lDebugAssert( getRefCount( index ) > 0 );
+         __atomic_add_fetch( &m_slots[ index ].refs, 1, __ATOMIC_RELAXED );
+      }
+
+      /**
+       * @brief  Drop a reference; the last one gives the buffer back
+       */
+      void release( int index )
+      {
+         int refs=__atomic_sub_fetch( &m_slots[ index ].refs, 1, __ATOMIC_ACQ_REL );
+
+         lAssert( refs >= 0 );
+         if( refs == 0 )
+         {
+            __atomic_sub_fetch( &m_used, 1, __ATOMIC_RELAXED );
+            pushFree( index );
+         }
+      }
+
+      int getRefCount( int index ) const
+      {
+         return( __atomic_load_n( &m_slots[ index ].refs, __ATOMIC_RELAXED ) );
+      }
+
+      void* getData( int index ) const
+      {
+         lDebugAssert( ( index >= 0 ) && ( index < m_buffers ) );
+         return( m_arena + index * m_stride );
+      }
+
+      //--- Handles ---------------------------------------------------------
+
+      /**
+       * @return Handle to a free buffer; an empty handle if the pool is
+       *         exhausted
+       */
+      CBufferHandle acquire()
+      {
+         int index=acquireIndex();
+
+         return( ( index < 0 ) ? CBufferHandle() : CBufferHandle( this, index ) );
+      }
+
+      /**
+       * @brief  Handle for an index of acquireIndex() or
+       *         CBufferHandle::detach(). Takes over its reference.
+       */
+      CBufferHandle adopt( int index )
+      {
+         return( ( index < 0 ) ? CBufferHandle() : CBufferHandle( this, index ) );
+      }
+
+      //--- Statistics ------------------------------------------------------
+
+      int getBufferSize() const
+      {
+         return( m_bufferSize );
+      }
+
+      int getMaxBuffers() const
+      {
+         return( m_buffers );
+      }
+
+      void* getArena() const
+      {
+         return( m_arena );
+      }
+
+      size_t getArenaSize() const
+      {
+         return( m_stride * m_buffers );
+      }
+
+      /**
+       * @brief  Number of buffers handed out right now
+       */
+      int getUsed() const
+      {
+         return( __atomic_load_n( &m_used, __ATOMIC_RELAXED ) );
+      }
+
+      int getFree() const
+      {
+         return( m_buffers - getUsed() );
+      }
+
+      /**
+       * @brief  Most buffers ever handed out at the same time
+       */
+      int getHighWater() const
+      {
+         return( __atomic_load_n( &m_highWater, __ATOMIC_RELAXED ) );
+      }
+
+      /**
+       * @brief  Number of acquires that failed because the pool was
+       *         exhausted
+       */
+      unsigned int getExhausted() const
+      {
+         return( __atomic_load_n( &m_exhausted, __ATOMIC_RELAXED ) );
+      }
+
+      void resetStatistics()
+      {
+         __atomic_store_n( &m_highWater, getUsed(), __ATOMIC_RELAXED );
+         __atomic_store_n( &m_exhausted, 0, __ATOMIC_RELAXED );
+      }
+};
+
+
+inline CBufferHandle::CBufferHandle( const CBufferHandle& other )
+   :m_pool( other.m_pool )
+   ,m_index( other.m_index )
+{
+   if( m_pool )
+   {
+      m_pool->retain( m_index );
+   }
+}
+
+inline void* CBufferHandle::data() const
+{
+   return( m_pool ? m_pool->getData( m_index ) : nullptr );
+}
+
+inline int CBufferHandle::size() const
+{
+   return( m_pool ? m_pool->getBufferSize() : 0 );
+}
+
+inline int CBufferHandle::getRefCount() const
+{
+   return( m_pool ? m_pool->getRefCount( m_index ) : 0 );
+}
+
+inline void CBufferHandle::reset()
+{
+   if( m_pool )
+   {
+      m_pool->release( m_index );
+      m_pool=nullptr;
+      m_index=-1;
+   }
+}
+
+
+/*--- Fin ------------------------------------------------------------------*/
+#endif // ? ! LEPTO_BUFFER_POOL_HPP
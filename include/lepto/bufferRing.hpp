@@ -6,7 +6,7 @@
  * @brief      Buffer ring; a variant of CRing
  *
  * There must be only exist one producer and one consumer at the same
- * time
+ * time. Therefore it is based on the wait-free CSpscRing.
  *
  * Empty:                        2 Entries:
  * [0 ] [1*] [2 ] [3 ] [4 ]      [0 ] [1*] [2*] [3 ] [4 ]
@@ -18,6 +18,40 @@
  *       |    \--m_top
  *       \-- m_bottom
  *
+ * All data buffers are carved from one contiguous arena which is allocated
+ * in the constructor and freed in the destructor. Every buffer starts at a
+ * multiple of 'alignment', e.g. CONFIG_LEPTO_CACHELINE_SIZE for DMA. Pass a
+ * CHugePageResource to back the arena with huge pages.
+ *
+ * Producers fill the buffers in place: reserveWrite() returns the free
+ * buffer, commitWrite() publishes it. Consumers read them in place via
+ * readSpan() and give them back with commitRead(). Nothing is copied.
+ *
+ * For vectored I/O, readVectors() returns all ready buffers as iovecs for
+ * one writev() and commitRead( n ) releases them at once. The producer
+ * mirror is reserveWriteVectors() for readv() and commitWriteBytes().
+ *
+ * With CONFIG_LEPTO_BUFFER_RING_TIMESTAMPS every buffer is stamped by
+ * CONFIG_LEPTO_BUFFER_RING_CLOCK when it is pushed. Releasing it records
+ * how long it was queued; see getLatency(). The default clock counts
+ * microseconds on Linux. Other targets have to define their own clock,
+ * e.g. '#define CONFIG_LEPTO_BUFFER_RING_CLOCK lrNow'.
+ *
+ * Example:
+ *    CBufferRing ring( 512, 8, nullptr, CONFIG_LEPTO_CACHELINE_SIZE );
+ *    SBufferSpan span=ring.reserveWrite();        // Producer
+ *    if( span.data )
+ *    {
+ *       ring.commitWrite( usbRead( span.data, span.size ) );
+ *    }
+ *
+ *    span=ring.readSpan();                         // Consumer
+ *    if( span.data )
+ *    {
+ *       write( fd, span.data, span.size );
+ *       ring.commitRead();
+ *    }
+ *
  * This class is used in biwak usb class.
  *
  * @date       20221222
@@ -30,8 +64,43 @@
 /*--- Includes -------------------------------------------------------------*/
 
 
-#include <lepto/ring.hpp>
-//#include <biwak/timer.h>
+#include <lepto/ringSpsc.hpp>
+
+#if defined( __linux__ )
+   #include <sys/uio.h>       // iovec
+#endif
+
+#if IS_ENABLED( CONFIG_LEPTO_BUFFER_RING_TIMESTAMPS ) && ! defined CONFIG_LEPTO_BUFFER_RING_CLOCK
+   #include <time.h>
+#endif
+
+
+/*--- Defines --------------------------------------------------------------*/
+
+
+#if IS_ENABLED( CONFIG_LEPTO_BUFFER_RING_TIMESTAMPS )
+
+   #if ! defined CONFIG_LEPTO_BUFFER_RING_CLOCK
+      #define CONFIG_LEPTO_BUFFER_RING_CLOCK          leptoBufferRingClock
+
+      /**
+       * @brief Monotonic time in microseconds
+       */
+      inline long long leptoBufferRingClock()
+      {
+         struct timespec now;
+         clock_gettime( CLOCK_MONOTONIC, &now );
+         return( ( (long long)now.tv_sec * 1000000 ) + ( now.tv_nsec / 1000 ) );
+      }
+   #endif
+
+   // Bucket n > 0 counts latencies in [2^(n-1), 2^n), bucket 0 the ones of
+   // 0 ticks; the last one also all above
+   #if ! defined CONFIG_LEPTO_BUFFER_RING_LATENCY_BUCKETS
+      #define CONFIG_LEPTO_BUFFER_RING_LATENCY_BUCKETS  24
+   #endif
+
+#endif
 
 
 /*--- Implementation -------------------------------------------------------*/
@@ -41,10 +110,81 @@ struct SBuffer{
    //bool used;
    int size;
    void *data;
-   // lrtimer_t timestamp;
+#if IS_ENABLED( CONFIG_LEPTO_BUFFER_RING_TIMESTAMPS )
+   long long timestamp;
+#endif
+};
+
+#if IS_ENABLED( CONFIG_LEPTO_BUFFER_RING_TIMESTAMPS )
+/**
+ * @brief Time buffers spent in the ring, in ticks of
+ *        CONFIG_LEPTO_BUFFER_RING_CLOCK
+ */
+struct SBufferLatency
+{
+   long long min;
+   long long max;
+   long long sum;
+   unsigned int count;
+   unsigned int histogram[ CONFIG_LEPTO_BUFFER_RING_LATENCY_BUCKETS ];
+
+   long long average() const
+   {
+      return( count ? ( sum / count ) : 0 );
+   }
+
+   /**
+    * @brief Upper bound of the latencies counted in 'bucket'; exclusive
+    */
+   static long long bucketLimit( int bucket )
+   {
+      return( 1LL << bucket );
+   }
+
+   void add( long long latency )
+   {
+      int bucket=( latency > 0 )
+            ? ( 64 - __builtin_clzll( (unsigned long long)latency ) ) : 0;
+
+      if( !count || ( latency < min ) )
+      {
+         min=latency;
+      }
+      if( !count || ( latency > max ) )
+      {
+         max=latency;
+      }
+      sum+=latency;
+      count++;
+      histogram[ MIN( bucket, CONFIG_LEPTO_BUFFER_RING_LATENCY_BUCKETS - 1 ) ]++;
+   }
 };
+#endif
 
-class CBufferRing: public CRing<SBuffer>
+/**
+ * @brief Buffer handed out for writing or reading in place
+ */
+struct SBufferSpan
+{
+   void* data;
+   int size;
+};
+
+#if defined( __linux__ )
+   typedef struct iovec bufferVector_t;
+#else
+   /**
+    * @brief Same layout as 'struct iovec'
+    */
+   struct SBufferVector
+   {
+      void* iov_base;
+      size_t iov_len;
+   };
+   typedef struct SBufferVector bufferVector_t;
+#endif
+
+class CBufferRing: public CSpscRing<SBuffer>
 {
    private:
 #if 0
@@ -63,29 +203,89 @@ class CBufferRing: public CRing<SBuffer>
       int m_usedBuffer;
 #endif
       int m_maxBufferSize;
+      CMemoryResource* m_resource;
+      size_t m_alignment;
+      size_t m_stride;
+      char* m_arena;
+#if IS_ENABLED( CONFIG_LEPTO_BUFFER_RING_TIMESTAMPS )
+      SBufferLatency m_latency;
+#endif
+
+      // Producer; the buffer is about to be pushed
+      void stamp( SBuffer* buffer )
+      {
+         #if IS_ENABLED( CONFIG_LEPTO_BUFFER_RING_TIMESTAMPS )
+            buffer->timestamp=CONFIG_LEPTO_BUFFER_RING_CLOCK();
+         #else
+            (void)buffer;
+         #endif
+      }
+
+      // Consumer; the first 'buffers' buffers are about to be dropped
+      void account( int buffers )
+      {
+         #if IS_ENABLED( CONFIG_LEPTO_BUFFER_RING_TIMESTAMPS )
+            long long now=CONFIG_LEPTO_BUFFER_RING_CLOCK();
+            SBuffer* buffer;
+
+            for( int i1=0; ( i1 < buffers ) && ( buffer=getFrontEntry( i1 ) ); i1++ )
+            {
+               m_latency.add( now - buffer->timestamp );
+            }
+         #else
+            (void)buffers;
+         #endif
+      }
 
    public:
 
-      CBufferRing(int bufferSize, int buffers)
-         :CRing(buffers)
+      /**
+       * @param resource: Memory for the ring and for the data arena;
+       *        nullptr for global new/delete
+       * @param alignment: Alignment of every data buffer; a power of two
+       */
+      CBufferRing(int bufferSize, int buffers, CMemoryResource* resource = nullptr,
+                  size_t alignment = alignof( max_align_t ) )
+         :CSpscRing(buffers, resource)
          ,m_maxBufferSize(bufferSize)
-         //,m_bufferCount(buffers)
-         //,m_bottomBuffer(0)
-         //,m_topBuffer(0)
-         //,m_currentBuffer(0)
-         //,m_usedBuffer(0)
+         ,m_resource(resource)
+         ,m_alignment(alignment)
+         ,m_stride( leptoStride( bufferSize, alignment ) )
+         #if IS_ENABLED( CONFIG_LEPTO_BUFFER_RING_TIMESTAMPS )
+         ,m_latency{}
+         #endif
       {
-         //m_buffers=new SBuffer[buffers];
-
+         m_arena=(char*)leptoAllocate( m_resource, getArenaSize(), m_alignment );
+         lFullAssert( m_arena != nullptr );
 
          for(int i1=0; i1<buffers; i1++)
          {
             SBuffer &buffer=rawEntry(i1);
-            //buffer.used=0;
-            buffer.data=malloc(bufferSize);
+            buffer.data=m_arena + i1 * m_stride;
             buffer.size=0;
          }
       }
+
+      ~CBufferRing()
+      {
+         leptoDeallocate( m_resource, m_arena, getArenaSize(), m_alignment );
+         m_arena=nullptr;
+      }
+
+      /**
+       * @brief Start of the arena holding all data buffers, e.g. for
+       *        registering it with a DMA controller once
+       */
+      void* getArena() const
+      {
+         return( m_arena );
+      }
+
+      size_t getArenaSize() const
+      {
+         return( m_stride * getMaxEntries() );
+      }
+
       int getMaxBufferSize() const
       {
          return(m_maxBufferSize);
@@ -102,7 +302,7 @@ class CBufferRing: public CRing<SBuffer>
             return(nullptr);
          }
          buffer->size=size;
-         // buffer->timestamp=lrNow();
+         stamp( buffer );
          pushBack();
          return( buffer->data );
       }
@@ -135,12 +335,173 @@ class CBufferRing: public CRing<SBuffer>
       void dropBuffer()
       {
          //lDebugAssert( m_bottomPos >= 0 );
+         account( 1 );
          dropFront();
       }
       int usedBuffers() const
       {
          return( count() );
       }
+
+      //--- Zero copy -------------------------------------------------------
+
+      /**
+       * @brief  Free buffer to be filled in place by the producer
+       * @return Buffer with its capacity; data is nullptr if the ring is
+       *         full
+       */
+      SBufferSpan reserveWrite() const
+      {
+         SBuffer* buffer=backEntry();
+
+         if( !buffer )
+         {
+            return( SBufferSpan{ nullptr, 0 } );
+         }
+         return( SBufferSpan{ buffer->data, m_maxBufferSize } );
+      }
+
+      /**
+       * @brief  Publish the buffer of reserveWrite() with 'size' bytes
+       */
+      void commitWrite( int size )
+      {
+         SBuffer* buffer=backEntry();
+
+         lAssert( buffer );
+         lDebugAssert( size <= m_maxBufferSize );
+         buffer->size=size;
+         stamp( buffer );
+         pushBack();
+      }
+
+      /**
+       * @brief  Oldest buffer to be read in place by the consumer
+       * @return Buffer with its size; data is nullptr if the ring is empty
+       */
+      SBufferSpan readSpan() const
+      {
+         SBuffer* buffer=frontEntry();
+
+         if( !buffer )
+         {
+            return( SBufferSpan{ nullptr, 0 } );
+         }
+         return( SBufferSpan{ buffer->data, buffer->size } );
+      }
+
+      /**
+       * @brief  Give the buffer of readSpan() back to the producer
+       */
+      void commitRead()
+      {
+         account( 1 );
+         dropFront();
+      }
+
+      //--- Scatter-gather --------------------------------------------------
+
+      /**
+       * @brief  Free buffers for readv(), in ring order
+       * @return Number of vectors filled; 0 if the ring is full
+       */
+      int reserveWriteVectors( bufferVector_t* vectors, int maxVectors ) const
+      {
+         int buffers=0;
+         SBuffer* buffer;
+
+         while( ( buffers < maxVectors ) && ( buffer=getBackEntry( buffers ) ) )
+         {
+            vectors[ buffers ].iov_base=buffer->data;
+            vectors[ buffers ].iov_len=m_maxBufferSize;
+            buffers++;
+         }
+         return( buffers );
+      }
+
+      /**
+       * @brief  Publish the buffers of reserveWriteVectors() which got
+       *         'bytes' bytes, e.g. the result of readv(). All but the last
+       *         one are full. Errors and end of file (bytes <= 0) publish
+       *         nothing; bytes beyond the free buffers are ignored.
+       * @return Number of buffers actually published
+       */
+      int commitWriteBytes( long long bytes )
+      {
+         int buffers=0;
+         SBuffer* buffer;
+
+         if( ( bytes <= 0 ) || ( m_maxBufferSize <= 0 ) )
+         {
+            return( 0 );
+         }
+         while( ( bytes > 0 ) && ( buffer=getBackEntry( buffers ) ) )
+         {
+            buffer->size=(int)MIN( bytes, (long long)m_maxBufferSize );
+            stamp( buffer );
+            bytes-=buffer->size;
+            buffers++;
+         }
+         pushBack( buffers );
+
+         return( buffers );
+      }
+
+      /**
+       * @brief  Buffers ready for writev() or sendmsg(), in ring order
+       * @return Number of vectors filled; 0 if the ring is empty
+       */
+      int readVectors( bufferVector_t* vectors, int maxVectors ) const
+      {
+         int buffers=0;
+         SBuffer* buffer;
+
+         while( ( buffers < maxVectors ) && ( buffer=getFrontEntry( buffers ) ) )
+         {
+            vectors[ buffers ].iov_base=buffer->data;
+            vectors[ buffers ].iov_len=buffer->size;
+            buffers++;
+         }
+         return( buffers );
+      }
+
+      /**
+       * @brief  Give the first 'buffers' buffers of readVectors() back to
+       *         the producer at once; nothing for 'buffers' <= 0
+       */
+      void commitRead( int buffers )
+      {
+         if( buffers <= 0 )
+         {
+            return;
+         }
+         account( buffers );
+         dropFront( buffers );
+      }
+
+#if IS_ENABLED( CONFIG_LEPTO_BUFFER_RING_TIMESTAMPS )
+
+      //--- Latency ---------------------------------------------------------
+
+      /**
+       * @brief  Queueing latency of all buffers released since the last
+       *         resetLatency(). Updated by the consumer; only a snapshot
+       *         when read from another thread.
+       */
+      const SBufferLatency& getLatency() const
+      {
+         return( m_latency );
+      }
+
+      /**
+       * @brief  Start a new measurement. Consumer only.
+       */
+      void resetLatency()
+      {
+         m_latency=SBufferLatency{};
+      }
+
+#endif
 };
 
 
@@ -0,0 +1,375 @@
+#ifndef LEPTO_HEAP_HPP
+#define LEPTO_HEAP_HPP
+/**---------------------------------------------------------------------------
+ *
+ * @file    heap.hpp
+ * @brief   Priority queues with fixed capacity
+ *
+ * The entries are kept as an implicit d-ary heap in one array. The front
+ * entry is the one no other entry compares before, e.g. the earliest
+ * deadline with the default SLess<T>:
+ *    push()         O(log n)
+ *    frontEntry()   O(1)
+ *    dropFront()    O(log n)
+ *    pushBulk()     O(n); rebuilds the heap bottom up when many entries are
+ *                   added at once
+ *
+ * CHeap takes its storage once in the constructor; CStaticHeap has it
+ * in-object like CStaticRing. Nothing is allocated afterwards, so both can
+ * be used for timers and deferred signals.
+ *
+ * A node has CONFIG_LEPTO_HEAP_ARITY children. 4 halves the depth of a
+ * binary heap and the children of small entries share a cache line.
+ *
+ * Not thread safe.
+ *
+ * Example:
+ *    static CStaticHeap<STimer, 16> timers;      // STimer has operator '<'
+ *    timers.push( STimer{ now + 100, callback } );
+ *    if( timers.frontEntry()->deadline <= now )
+ *    {
+ *       timers.pop( timer );
+ *    }
+ *
+ * @date   20261017
+ * @author Maximilian Seesslen <src@seesslen.net>
+ * @copyright SPDX-License-Identifier: Apache-2.0
+ *
+ *--------------------------------------------------------------------------*/
+
+
+/*--- Includes -------------------------------------------------------------*/
+
+
+#include <lepto/lepto.h>            // IS_ENABLED, MIN
+#include <lepto/log.h>              // lAssert
+#include <lepto/tuple.hpp>          // doMove
+#include <new>                      // placement new
+#include <lepto/memoryResource.hpp>
+
+
+/*--- Defines --------------------------------------------------------------*/
+
+
+#if ! defined CONFIG_LEPTO_HEAP_ARITY
+   #define CONFIG_LEPTO_HEAP_ARITY        4
+#endif
+
+
+/*--- Definitions ----------------------------------------------------------*/
+
+
+/**
+ * @brief Default order; smallest entry first
+ */
+template <typename T>
+struct SLess
+{
+   bool operator()( const T& a, const T& b ) const
+   {
+      return( a < b );
+   }
+};
+
+
+/**
+ * @brief Heap operations on storage owned by the derived class
+ */
+template <typename T, typename Compare, int ARITY>
+class CHeapBase
+{
+   static_assert( ARITY >= 2, "A heap node needs at least 2 children" );
+
+   protected:
+      T* m_entries;
+      int m_count;
+      int m_maxEntries;
+      Compare m_compare;
+
+      constexpr CHeapBase( T* entries, int maxEntries )
+         :m_entries( entries )
+         ,m_count( 0 )
+         ,m_maxEntries( maxEntries )
+         ,m_compare()
+      {
+      }
+
+      // The entry at 'pos' moves up as long as it comes before its parent
+      void siftUp( int pos )
+      {
+         T value( doMove( m_entries[ pos ] ) );
+
+         while( pos > 0 )
+         {
+            int parent=( pos - 1 ) / ARITY;
+            if( ! m_compare( value, m_entries[ parent ] ) )
+            {
+               break;
+            }
+            m_entries[ pos ]=doMove( m_entries[ parent ] );
+            pos=parent;
+         }
+         m_entries[ pos ]=doMove( value );
+      }
+
+      // The entry at 'pos' moves down as long as a child comes before it
+      void siftDown( int pos )
+      {
+         T value( doMove( m_entries[ pos ] ) );
+
+         while( true )
+         {
+            int first=pos * ARITY + 1;
+            if( first >= m_count )
+            {
+               break;
+            }
+            int last=MIN( first + ARITY, m_count );
+            int best=first;
+            for( int child=first + 1; child < last; child++ )
+            {
+               best=m_compare( m_entries[ child ], m_entries[ best ] ) ? child : best;
+            }
+            if( ! m_compare( m_entries[ best ], value ) )
+            {
+               break;
+            }
+            m_entries[ pos ]=doMove( m_entries[ best ] );
+            pos=best;
+         }
+         m_entries[ pos ]=doMove( value );
+      }
+
+      void removeAt( int pos )
+      {
+         m_count--;
+         if( pos == m_count )
+         {
+            return;
+         }
+         m_entries[ pos ]=doMove( m_entries[ m_count ] );
+         // Only one of them moves the entry
+         siftDown( pos );
+         siftUp( pos );
+      }
+
+   public:
+      CHeapBase( const CHeapBase& ) = delete;
+      CHeapBase& operator=( const CHeapBase& ) = delete;
+
+      int count() const
+      {
+         return( m_count );
+      }
+
+      int getMaxEntries() const
+      {
+         return( m_maxEntries );
+      }
+
+      bool isFull() const
+      {
+         return( m_count == m_maxEntries );
+      }
+
+      bool isDataAvailable() const
+      {
+         return( m_count > 0 );
+      }
+
+      void clear()
+      {
+         m_count=0;
+      }
+
+      bool push( const T& value )
+      {
+         if( isFull() )
+         {
+            return( false );
+         }
+         m_entries[ m_count ]=value;
+         siftUp( m_count++ );
+
+         return( true );
+      }
+
+      bool push( T&& value )
+      {
+         if( isFull() )
+         {
+            return( false );
+         }
+         m_entries[ m_count ]=doMove( value );
+         siftUp( m_count++ );
+
+         return( true );
+      }
+
+      CHeapBase& operator << ( const T& value )
+      {
+         push( value );
+         return( *this );
+      }
+
+      /**
+       * @brief  Push up to n entries at once. Many entries compared to the
+       *         content are added by rebuilding the heap bottom up (Floyd).
+       * @return Number of entries actually pushed
+       */
+      int pushBulk( const T* values, int n )
+      {
+         int previous=m_count;
+
+         n=MIN( n, m_maxEntries - m_count );
+         for( int i1=0; i1<n; i1++ )
+         {
+            m_entries[ m_count++ ]=values[i1];
+         }
+
+         if( n > previous )
+         {
+            for( int pos=( m_count - 2 ) / ARITY; pos >= 0; pos-- )
+            {
+               siftDown( pos );
+            }
+         }
+         else
+         {
+            for( int pos=previous; pos < m_count; pos++ )
+            {
+               siftUp( pos );
+            }
+         }
+
+         return( n );
+      }
+
+      /**
+       * @brief  Entry that comes first
+       * @return nullptr if the heap is empty
+       */
+      const T* frontEntry() const
+      {
+         return( m_count ? &m_entries[0] : nullptr );
+      }
+
+      void dropFront()
+      {
+         if( !m_count )
+         {
+            lFatal("NE");
+         }
+         removeAt( 0 );
+      }
+
+      /**
+       * @brief  Move the entry that comes first into 'value'
+       * @return false if the heap is empty
+       */
+      bool pop( T& value )
+      {
+         if( !m_count )
+         {
+            return( false );
+         }
+         value=doMove( m_entries[0] );
+         removeAt( 0 );
+
+         return( true );
+      }
+
+      /**
+       * @brief  Remove the first entry equal to 'value', e.g. a cancelled
+       *         timer. O(n) for searching.
+       * @return false if there is no such entry
+       */
+      bool remove( const T& value )
+      {
+         for( int i1=0; i1<m_count; i1++ )
+         {
+            if( m_entries[i1] == value )
+            {
+               removeAt( i1 );
+               return( true );
+            }
+         }
+         return( false );
+      }
+};
+
+
+/**
+ * @brief Heap with storage taken once on construction
+ */
+template <typename T, typename Compare = SLess<T>, int ARITY = CONFIG_LEPTO_HEAP_ARITY>
+class CHeap: public CHeapBase<T, Compare, ARITY>
+{
+   private:
+      CMemoryResource* m_resource;
+
+   public:
+      /**
+       * @param resource: Where to take the storage from; nullptr for
+       *        global new/delete
+       */
+      CHeap( int maxEntries, CMemoryResource* resource = nullptr )
+         :CHeapBase<T, Compare, ARITY>( nullptr, maxEntries )
+         ,m_resource( resource )
+      {
+         if( m_resource )
+         {
+            T* entries=(T*)m_resource->allocate( maxEntries * sizeof( T ), alignof( T ) );
+            lAssert( entries );
+            for( int i1=0; i1<maxEntries; i1++ )
+            {
+               new( &entries[i1] ) T();
+            }
+            this->m_entries=entries;
+         }
+         else
+         {
+            this->m_entries=new T[ maxEntries ];
+         }
+      }
+
+      ~CHeap()
+      {
+         if( m_resource )
+         {
+            for( int i1=0; i1 < this->m_maxEntries; i1++ )
+            {
+               this->m_entries[i1].~T();
+            }
+            m_resource->deallocate( this->m_entries, this->m_maxEntries * sizeof( T ), alignof( T ) );
+         }
+         else
+         {
+            delete[] this->m_entries;
+         }
+      }
+};
+
+
+/**
+ * @brief Heap with in-object storage; no allocation at all
+ */
+template <typename T, int N, typename Compare = SLess<T>, int ARITY = CONFIG_LEPTO_HEAP_ARITY>
+class CStaticHeap: public CHeapBase<T, Compare, ARITY>
+{
+   static_assert( N > 0, "Capacity must not be 0" );
+
+   private:
+      T m_storage[ N ];
+
+   public:
+      constexpr CStaticHeap()
+         :CHeapBase<T, Compare, ARITY>( m_storage, N )
+         ,m_storage{}
+      {
+      }
+};
+
+
+/*--- Fin ------------------------------------------------------------------*/
+#endif // ? ! LEPTO_HEAP_HPP
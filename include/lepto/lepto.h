@@ -60,6 +60,10 @@
 
 typedef int lsize_t;
 
+#if ! defined CONFIG_LEPTO_CACHELINE_SIZE
+   #define CONFIG_LEPTO_CACHELINE_SIZE          64
+#endif
+
 // When CONFIG_LEPTO_LOG_PRETTY_PRINT is not defined, enable it only when
 // CONFIG_LEPTO_LOG_DOWNSIZE is not set.
 // Make it a nice default configuration.
@@ -42,7 +42,27 @@
  *          CONFIG_LEPTO_LIST_RESIZABLE
  *             Support automatic expanding os lists when pushing data to a
  *             full list. This can be decactivated by calling the method
- *             "setExpandable( false )".
+ *             "setExpandable( false )". By default the capacity is doubled,
+ *             "setGrowth( EListGrowth::Linear )" grows by
+ *             CONFIG_LEPTO_LIST_INCREMENT entries instead. Producers may push
+ *             concurrently while the list expands; the consumer must not be
+ *             active at the same time.
+ *          CONFIG_LEPTO_RING_CACHELINE_SEPARATION
+ *             Place the consumer index and the producer index in separate
+ *             cache lines of CONFIG_LEPTO_CACHELINE_SIZE bytes. Each side
+ *             keeps a copy of the other sides index and only reloads it when
+ *             the ring looks full/empty. Costs some bytes of RAM per list.
+ *             Off by default: it has only been measured on a single core
+ *             host so far, where it is slightly slower. The back index copy
+ *             is only ever written by the consumer.
+ *
+ * The storage is allocated uninitialized. Entries are constructed when
+ * pushed and destroyed when dropped, so creating a big list costs nothing
+ * and T does not need a default constructor. Entries returned by
+ * backEntry() and reservedEntry() are not constructed yet; for other than
+ * trivial types they have to be constructed with placement new.
+ * The storage is taken from global new/delete unless a CMemoryResource is
+ * passed to the constructor.
  *
  * The behaviour is similar to QList/std::list.
  *
@@ -59,8 +79,13 @@
 #include <stdlib.h>        // malloc, free
 #include <stdio.h>         // printf
 #include <string.h>        // memset
+#include <stddef.h>        // ptrdiff_t
+#include <new>             // placement new
+#include <iterator>        // random_access_iterator_tag
 #include <lepto/log.h>     //
 #include <lepto/lepto.h>   // IS_ENABLED
+#include <lepto/tuple.hpp>  // doForward, doMove
+#include <lepto/memoryResource.hpp>
 
 
 /*--- Defines --------------------------------------------------------------*/
@@ -70,12 +95,34 @@
 #  define CONFIG_LEPTO_RING_DEFAULT_SIZE 0x0
 #endif
 
-#define CONFIG_LEPTO_LIST_INCREMENT       8
+#if ! defined CONFIG_LEPTO_LIST_INCREMENT
+   #define CONFIG_LEPTO_LIST_INCREMENT       8
+#endif
+
+// Called by threads waiting for an other thread, e.g. expanding the list
+#if ! defined CONFIG_LEPTO_RING_RELAX
+   #if defined( __unix__ )
+      #include <sched.h>      // sched_yield
+      #define CONFIG_LEPTO_RING_RELAX()   sched_yield()
+   #else
+      #define CONFIG_LEPTO_RING_RELAX()
+   #endif
+#endif
 
 #if ! defined(LEPTO_CONFIGURED)
    #error LEPTO_CONFIGURED not defined. The configuration header was probably not involved.
 #endif
 
+#if IS_ENABLED( CONFIG_LEPTO_RING_CACHELINE_SEPARATION )
+   #if IS_ENABLED( CONFIG_LEPTO_RING_DOWNSIZE )
+      #error CONFIG_LEPTO_RING_CACHELINE_SEPARATION needs the duplicated index \
+             range. It can not be used with CONFIG_LEPTO_RING_DOWNSIZE.
+   #endif
+   #define LEPTO_RING_CACHELINE_ALIGNED   alignas( CONFIG_LEPTO_CACHELINE_SIZE )
+#else
+   #define LEPTO_RING_CACHELINE_ALIGNED
+#endif
+
 #if IS_ENABLED( CONFIG_LEPTO_RING_DOWNSIZE )
    #define MOD_ENTRY                   % m_maxEntries
    #define MOD_ENTRY_ITERATOR          % m_parent->m_maxEntries
@@ -94,6 +141,33 @@
 //---Definitions---------------------------------------------------------------
 
 
+/**
+ * @brief How resizable lists grow when they are full
+ */
+enum class EListGrowth
+{
+   Linear,        ///< Add CONFIG_LEPTO_LIST_INCREMENT entries
+   Geometric,     ///< Double the capacity
+};
+
+
+/**
+ * @brief Type used for summing up entries of type T; wide enough for
+ *        65536 entries of small integers
+ */
+template <typename T> struct SAccumulator         { typedef T type; };
+template <> struct SAccumulator<char>             { typedef int type; };
+template <> struct SAccumulator<signed char>      { typedef int type; };
+template <> struct SAccumulator<unsigned char>    { typedef unsigned int type; };
+template <> struct SAccumulator<short>            { typedef int type; };
+template <> struct SAccumulator<unsigned short>   { typedef unsigned int type; };
+template <> struct SAccumulator<int>              { typedef long long type; };
+template <> struct SAccumulator<unsigned int>     { typedef unsigned long long type; };
+template <> struct SAccumulator<long>             { typedef long long type; };
+template <> struct SAccumulator<unsigned long>    { typedef unsigned long long type; };
+template <> struct SAccumulator<float>            { typedef double type; };
+
+
 #if IS_ENABLED( CONFIG_LEPTO_RING_DOWNSIZE )
    // Smaller types increase
    typedef unsigned int ringIndex_t;
@@ -108,18 +182,37 @@ class CList
 {
    private:
       T* m_buffers;
-      #if ! IS_ENABLED( CONFIG_LEPTO_RING_NO_THREADS )
-      int m_busyProducing=0;
-      #endif
 
       #if ! IS_ENABLED( CONFIG_LEPTO_RING_DOWNSIZE )
          static constexpr int DUPLICATE_FACTOR = 0x10000; // 0x1000 was not enough for 4-thread-test
+
+         // Keep the duplicated range in 31 bits also for big lists
+         static ringIndex_t duplicatedEntries( int maxEntries, int factor = DUPLICATE_FACTOR )
+         {
+            return( maxEntries ?
+                  maxEntries * MIN( factor, (int)( 0x7FFFFFFF / maxEntries ) ) : 0 );
+         }
       #endif
 
    private:
-      ringIndex_t m_frontPos;
-      ringIndex_t m_backPos;
-      ringIndex_t m_maxEntries;
+      // Consumer side
+      LEPTO_RING_CACHELINE_ALIGNED ringIndex_t m_frontPos;
+      #if IS_ENABLED( CONFIG_LEPTO_RING_CACHELINE_SEPARATION )
+      mutable ringIndex_t m_backCache=0;
+      #endif
+
+      // Producer side
+      LEPTO_RING_CACHELINE_ALIGNED ringIndex_t m_backPos;
+      #if ! IS_ENABLED( CONFIG_LEPTO_RING_NO_THREADS )
+      int m_busyProducing=0;
+      #endif
+      #if IS_ENABLED( CONFIG_LEPTO_RING_CACHELINE_SEPARATION )
+      ringIndex_t m_frontCache=0;
+      #endif
+
+      // Read mostly
+      LEPTO_RING_CACHELINE_ALIGNED ringIndex_t m_maxEntries;
+      CMemoryResource* m_resource;
       
       #if ! IS_ENABLED( CONFIG_LEPTO_RING_DOWNSIZE )
          unsigned int m_maxEntriesDuplicated;
@@ -131,69 +224,237 @@ class CList
 
       #if IS_ENABLED( CONFIG_LEPTO_LIST_RESIZABLE )
       bool m_resizable = true;
+      EListGrowth m_growth = EListGrowth::Geometric;
+         #if ! IS_ENABLED( CONFIG_LEPTO_RING_NO_THREADS )
+         int m_expanding = 0;
+         #endif
       #endif
 
    public:
 
-      class CIterator
+      /**
+       * @brief Random access iterator over the entries
+       *
+       * Holds the position in the duplicated index range, like m_frontPos,
+       * together with the slot in the buffer. Both are wrapped by comparison
+       * when stepping, so dereferencing needs no modulo. Differences and
+       * ordering are taken relative to the current front.
+       * Expanding the list invalidates all iterators.
+       */
+      template <typename R>
+      class CIteratorBase
       {
+         template <typename> friend class CIteratorBase;
+         friend class CList;
+
          private:
             const CList* m_parent;
             ringIndex_t m_pos;
+            ringIndex_t m_slot;
+
+            // 'n' has to be smaller than 'range'
+            static ringIndex_t wrap( ringIndex_t value, ptrdiff_t n, ringIndex_t range )
+            {
+               if( n >= 0 )
+               {
+                  value+=(ringIndex_t)n;
+                  return( ( value >= range ) ? ( value - range ) : value );
+               }
+               ringIndex_t back=(ringIndex_t)-n;
+               return( ( value >= back ) ? ( value - back ) : ( value + range - back ) );
+            }
+
+            void setPosition( ringIndex_t pos )
+            {
+               m_pos=pos;
+               m_slot=m_parent->m_maxEntries ? ( pos MOD_ENTRY_ITERATOR ) : 0;
+            }
+
+            ptrdiff_t offset() const
+            {
+               ringIndex_t front=m_parent->m_frontPos;
+               return( ( m_pos >= front ) ? (ptrdiff_t)( m_pos - front )
+                       : (ptrdiff_t)( m_pos + m_parent->duplicatedRange() - front ) );
+            }
+
          public:
-            constexpr CIterator(const CList* parent, ringIndex_t pos)
+            typedef std::random_access_iterator_tag iterator_category;
+            typedef T value_type;
+            typedef ptrdiff_t difference_type;
+            typedef R* pointer;
+            typedef R& reference;
+
+            CIteratorBase(const CList* parent, ringIndex_t pos)
                 :m_parent( parent )
-                ,m_pos(pos)
             {
+               setPosition( pos );
             };
-            bool operator !=(const CIterator& other) const
+
+            // Copy constructor; for const_iterator also the conversion
+            // from iterator
+            CIteratorBase( const CIteratorBase<T>& other )
+                :m_parent( other.m_parent )
+                ,m_pos( other.m_pos )
+                ,m_slot( other.m_slot )
+            {
+            }
+
+            CIteratorBase& operator =( const CIteratorBase& other ) = default;
+
+            CIteratorBase& operator =( ringIndex_t pos )
+            {
+               setPosition( pos );
+               return( *this );
+            }
+
+            template <typename O>
+            bool operator !=(const CIteratorBase<O>& other) const
             {
-               return( other.m_pos !=m_pos );
+               return( other.m_pos != m_pos );
             }
-            bool operator ==(const CIterator& other) const
+            template <typename O>
+            bool operator ==(const CIteratorBase<O>& other) const
             {
                return( other.m_pos == m_pos );
             }
-            void operator =(ringIndex_t pos)
+            template <typename O>
+            bool operator <(const CIteratorBase<O>& other) const
             {
-               m_pos = pos;
-               return;
+               return( offset() < other.offset() );
             }
-            const T& operator *() const
+            template <typename O>
+            bool operator >(const CIteratorBase<O>& other) const
             {
-               return( m_parent->m_buffers[ m_pos MOD_ENTRY_ITERATOR ] );
+               return( other < *this );
             }
-            CIterator& operator ++(int)
+            template <typename O>
+            bool operator <=(const CIteratorBase<O>& other) const
             {
-               // The int is dummy and is 0;
-               // its used to distinguish ++i vs i++;
-               return( (*this)+=1 );
+               return( !( other < *this ) );
+            }
+            template <typename O>
+            bool operator >=(const CIteratorBase<O>& other) const
+            {
+               return( !( *this < other ) );
+            }
+
+            R& operator *() const
+            {
+               return( m_parent->m_buffers[ m_slot ] );
+            }
+            R* operator ->() const
+            {
+               return( &m_parent->m_buffers[ m_slot ] );
+            }
+            R& operator []( ptrdiff_t n ) const
+            {
+               return( *( *this + n ) );
+            }
+
+            CIteratorBase& operator +=( ptrdiff_t n )
+            {
+               ringIndex_t size=m_parent->m_maxEntries;
+
+               if( ( n < (ptrdiff_t)size ) && ( -n < (ptrdiff_t)size ) )
+               {
+                  m_pos=wrap( m_pos, n, m_parent->duplicatedRange() );
+                  m_slot=wrap( m_slot, n, size );
+               }
+               else
+               {
+                  ringIndex_t range=m_parent->duplicatedRange();
+                  setPosition( wrap( m_pos, n % (ptrdiff_t)range, range ) );
+               }
+               return( *this );
             }
-            CIterator& operator +=(int number);
-            CIterator& operator ++()
+            CIteratorBase& operator -=( ptrdiff_t n )
+            {
+               return( (*this)+=-n );
+            }
+            CIteratorBase& operator ++()
             {
                return( (*this)+=1 );
             }
-            ringIndex_t realIndex() const
+            CIteratorBase& operator --()
             {
-               return( m_parent->realIndex( m_pos ) );
+               return( (*this)+=-1 );
             }
-            ringIndex_t index()
+            CIteratorBase operator ++(int)
             {
-               return( m_pos );
+               CIteratorBase previous( *this );
+               (*this)+=1;
+               return( previous );
             }
-            CIterator operator +( int add )
+            CIteratorBase operator --(int)
             {
-               return( CIterator( index() + add ) );
+               CIteratorBase previous( *this );
+               (*this)+=-1;
+               return( previous );
             }
-            CIterator& operator =( int pos )
+            CIteratorBase operator +( ptrdiff_t n ) const
             {
-               m_pos=pos;
-               return(*this);
+               CIteratorBase moved( *this );
+               return( moved+=n );
+            }
+            friend CIteratorBase operator +( ptrdiff_t n, const CIteratorBase& iterator )
+            {
+               return( iterator + n );
+            }
+            CIteratorBase operator -( ptrdiff_t n ) const
+            {
+               CIteratorBase moved( *this );
+               return( moved+=-n );
+            }
+            template <typename O>
+            ptrdiff_t operator -( const CIteratorBase<O>& other ) const
+            {
+               return( offset() - other.offset() );
+            }
+
+            ringIndex_t realIndex() const
+            {
+               return( m_slot );
+            }
+            ringIndex_t index() const
+            {
+               return( m_pos );
             }
       };
-      
-      CList(int maxEntries = CONFIG_LEPTO_RING_DEFAULT_SIZE);
+
+      typedef CIteratorBase<T> CIterator;
+      typedef CIterator iterator;
+      typedef CIteratorBase<const T> const_iterator;
+
+      /**
+       * @brief Contiguous range of slots
+       */
+      struct SSpan
+      {
+         T* data;
+         int size;
+      };
+
+      /**
+       * @brief Ring content as up to two contiguous ranges. The second one
+       *        is only used when the content wraps at the end of the buffer.
+       */
+      struct SSpans
+      {
+         SSpan first;
+         SSpan second;
+
+         int size() const
+         {
+            return( first.size + second.size );
+         }
+      };
+
+      /**
+       * @param resource: Where to take the storage from; nullptr for
+       *        global new/delete
+       */
+      CList(int maxEntries = CONFIG_LEPTO_RING_DEFAULT_SIZE,
+            CMemoryResource* resource = nullptr);
       ~CList();
 
       #if CONFIG_LEPTO_RING_DEFAULT_SIZE == 0
@@ -222,7 +483,8 @@ class CList
       
       /**
        * @brief Get pointer to the entry at top position.
-       *        This can be used before pushBack() is called.
+       *        This can be used before pushBack() is called. The entry is
+       *        not constructed.
        *
        * @return Pointer to top entry or nullptr if free entries are available
        */
@@ -248,6 +510,7 @@ class CList
          m_frontPos = front;
          m_backPos = back;
          m_maxEntries = maxEntries;
+         resetIndexCaches();
          
          if( m_buffers )
          {
@@ -259,23 +522,52 @@ class CList
          #if ! IS_ENABLED( CONFIG_LEPTO_RING_DOWNSIZE )
          // Can not use huge loops in counter when super big lists are used
          // e.g. for blocks of SD card
-         m_maxEntriesDuplicated = ( maxEntries *
+         m_maxEntriesDuplicated = duplicatedEntries( maxEntries,
                ( (m_maxEntries>0x10000) ? 0x4 : DUPLICATE_FACTOR ) );
          #endif
          
          return;
       }
       
-      CList<T>& operator << (const T value)
+      CList<T>& operator << (const T& value)
       {
          push_back(value);
          return( *this );
       };
 
+      CList<T>& operator << (T&& value)
+      {
+         push_back( doMove(value) );
+         return( *this );
+      };
+
       /**
        * @brief Push an entry to the back.
        */
-      bool push_back(const T value);
+      bool push_back(const T& value);
+
+      /**
+       * @brief Push an entry to the back by moving it into the slot.
+       */
+      bool push_back(T&& value);
+
+      /**
+       * @brief Construct an entry from 'args' in place at the back.
+       */
+      template <typename... Args>
+      bool emplace_back(Args&&... args)
+      {
+         ringIndex_t index=reserveBack();
+
+         if( index == (ringIndex_t)-1 )
+         {
+            return(false);
+         }
+         new( reservedEntry(index) ) T( doForward<Args>(args)... );
+         pushReserved( index );
+
+         return(true);
+      }
       
       /**
        * @brief Push an entry to the back. Not thread safe. 
@@ -287,12 +579,85 @@ class CList
        */
       T pop();
 
+      /**
+       * @brief Move the bottom entry into 'value'.
+       * @return false if no entry was available
+       */
+      bool pop(T& value);
+
       /**
        * @brief Drop the entry at bottom position.
        */
       void dropFront();
+
+      /**
+       * @brief Push up to n entries at once.
+       *
+       *        The entries are reserved by a single atomic operation and
+       *        copied across the wrap point in at most two chunks. Thread safe
+       *        like push_back(). The list is not expanded.
+       *
+       * @return Number of entries actually pushed
+       */
+      int pushBulk(const T* values, int n);
+
+      /**
+       * @brief Pop up to n entries at once into 'values'.
+       * @return Number of entries actually popped
+       */
+      int popBulk(T* values, int n);
+
+      /**
+       * @brief Get the poppable entries as up to two contiguous spans.
+       *
+       *        The consumer can process the spans in place and release them
+       *        with commit() afterwards. Empty spans are returned as long as
+       *        producers are busy (see isDataAvailable()).
+       */
+      SSpans readableSpans() const;
+
+      /**
+       * @brief Get the entries as up to two contiguous spans; the second
+       *        one is only used when the content wraps.
+       *
+       *        Unlike readableSpans() busy producers are not taken into
+       *        account. For the consumer or lists used by a single thread;
+       *        std algorithms, memcpy() and vectorized loops can work on the
+       *        plain arrays.
+       */
+      SSpans segments() const
+      {
+         return( entrySpans() );
+      }
+
+      /**
+       * @brief Drop n entries from the front after processing
+       *        readableSpans().
+       */
+      void commit(int n);
       
       const T *putString(const T *str);
+
+      typedef typename SAccumulator<T>::type accumulator_t;
+
+      /**
+       * @brief Sum of all entries in the wider accumulator_t. The buffer is
+       *        walked as two plain arrays, so the loops can be vectorized.
+       */
+      accumulator_t sum() const;
+
+      /**
+       * @brief Sum divided by the number of entries in accumulator_t
+       *        precision; 0 for an empty list
+       */
+      accumulator_t mean() const;
+
+      /**
+       * @brief Smallest/biggest entry; T{} for an empty list
+       */
+      T min() const;
+      T max() const;
+
       T crosssum() const;
       T average() const;
 
@@ -302,6 +667,8 @@ class CList
        *
        *          If ringbuffer is volatile it will forget older entries when
        *          new value is pushed but the buffer is already full.
+       *          The producer drops the front itself, so this is not safe
+       *          with concurrent producers or consumers; see CLossyRing.
        */
       void setVolatile(bool _volatile)
       {
@@ -320,7 +687,7 @@ class CList
 
       int distance( CIterator front, CIterator back ) const
       {
-         return( distance(front.getIndex(), back.getIndex() ) );
+         return( distance( front.index(), back.index() ) );
       }
 
       int distance( ringIndex_t front, ringIndex_t back ) const
@@ -421,9 +788,18 @@ class CList
             __atomic_add_fetch(&m_busyProducing, 1, __ATOMIC_SEQ_CST);
          #endif
 
+         #if IS_ENABLED( CONFIG_LEPTO_LIST_RESIZABLE ) && ! IS_ENABLED( CONFIG_LEPTO_RING_NO_THREADS )
+            // Buffer is about to be exchanged. Behave like a full list.
+            if( __atomic_load_n( &m_expanding, __ATOMIC_SEQ_CST ) )
+            {
+               __atomic_sub_fetch(&m_busyProducing, 1, __ATOMIC_SEQ_CST);
+               return(-1);
+            }
+         #endif
+
          do{
             reserved=m_backPos;
-            ringIndex_t front=m_frontPos;
+            ringIndex_t front=producerFront( reserved );
 
             if( isFull(front, reserved) )
             {
@@ -499,7 +875,8 @@ class CList
       }
       
       /**
-       * @brief   Get pointer to an previously reserved entry
+       * @brief   Get pointer to an previously reserved entry. The entry is
+       *          not constructed.
        */
       T* reservedEntry(ringIndex_t index) const
       {
@@ -528,11 +905,12 @@ class CList
             m_maxEntries = maxEntries;
             
             #if ! IS_ENABLED( CONFIG_LEPTO_RING_DOWNSIZE )
-               m_maxEntriesDuplicated = maxEntries * DUPLICATE_FACTOR;
+               m_maxEntriesDuplicated = duplicatedEntries( maxEntries );
             #endif
          }
          m_frontPos=( front MOD_DUPLICATED );
          m_backPos=( back MOD_DUPLICATED );
+         resetIndexCaches();
       }
       
       /**
@@ -557,14 +935,24 @@ class CList
          return( CIterator( this, m_backPos ) );
       }
 
-      const CIterator begin() const
+      const_iterator begin() const
       {
-         return( CIterator( this, m_frontPos ) );
+         return( const_iterator( this, m_frontPos ) );
       }
 
-      const CIterator end() const
+      const_iterator end() const
       {
-         return( CIterator( this, m_backPos ) );
+         return( const_iterator( this, m_backPos ) );
+      }
+
+      const_iterator cbegin() const
+      {
+         return( begin() );
+      }
+
+      const_iterator cend() const
+      {
+         return( end() );
       }
       static void left(CIterator& front, CIterator& mid, CIterator& back)
       {
@@ -590,17 +978,25 @@ class CList
          m_resizable = resizable;
       }
 
+      /**
+       * @brief Set how the list grows when it is full
+       */
+      void setGrowth( EListGrowth growth )
+      {
+         m_growth = growth;
+      }
+
       #endif
 
       /**
        * @brief Find element in list.
        *
        * The returned iterator points to the element that is equal or bigger
-       * than the wanted.
+       * than the wanted; end() if all elements are smaller.
        * The operator '<' for comparing has to be implemented seperately.
        * e.g. "bool operator <(CList<bool>::CIterator i1, const int i2)"
        * By using th eiterator the list does not need to contain the data itself
-       * (m_buffers==nullptr).
+       * (m_buffers==nullptr). Lists with data should use lower_bound().
        *
        * @param element  Element to be find.
        * @return  Iterator to element.
@@ -608,67 +1004,326 @@ class CList
       template< typename C >
       CIterator find(const C& element);
 
-   protected:
+      /**
+       * @brief Range of logical positions, relative to the front
+       */
+      struct SRange
+      {
+         int first;
+         int last;                     // Behind the range
+
+         int size() const
+         {
+            return( last - first );
+         }
+      };
 
       /**
-       * @brief Direct reference to entry
-       *        This is only used in inherited classes.
-       * @param pos: Real index to entry
-       * @return reference
+       * @brief Search in a list sorted in ascending order.
+       *
+       * The content is split into its two contiguous parts once; the search
+       * then runs branchless on the plain array. Needs 'T < C' and 'C < T'.
+       * Not to be used while producers are pushing.
+       *
+       * @return Logical position of the first entry not less than 'value';
+       *         count() if there is none. See getEntry() and at().
        */
-      T &rawEntry(ringIndex_t pos) const
+      template< typename C >
+      int lower_bound(const C& value) const
       {
-         lAssert( pos <= m_maxEntries );
-         return( m_buffers[ pos MOD_ENTRY ] );
+         return( bound<false>( value, count() ) );
       }
 
-      #if IS_ENABLED( CONFIG_LEPTO_LIST_RESIZABLE )
-      bool expand( void );
-      #endif
+      /**
+       * @return Logical position of the first entry bigger than 'value';
+       *         count() if there is none
+       */
+      template< typename C >
+      int upper_bound(const C& value) const
+      {
+         return( bound<true>( value, count() ) );
+      }
 
-      void allocate( int size );
+      /**
+       * @return Positions of all entries equal to 'value'
+       */
+      template< typename C >
+      SRange equal_range(const C& value) const
+      {
+         return( SRange{ lower_bound( value ), upper_bound( value ) } );
+      }
 
-};
+      /**
+       * @brief Insert into a list sorted in ascending order, behind entries
+       *        equal to 'value'. Pushes like push_back() and moves the
+       *        bigger entries up by one. Not thread safe.
+       */
+      bool insertSorted(const T& value);
 
+   protected:
 
-template <typename T>
-CList<T>::CList(int maxEntries)
-   :m_frontPos(0)
-   ,m_backPos(0)
-   ,m_maxEntries(maxEntries)
-   #if ! IS_ENABLED( CONFIG_LEPTO_RING_DOWNSIZE )
-   ,m_maxEntriesDuplicated( maxEntries * DUPLICATE_FACTOR )
-   #endif
-   #if IS_ENABLED( CONFIG_LEPTO_RING_SUPPORT_VOLATILE )
-   ,m_volatile(false)
-   #endif
-{
-   if( m_maxEntries )
-   {
-      m_buffers=new T[ m_maxEntries ];
-      lFullAssert( m_buffers != nullptr );
-   }
-   else
-   {
-      m_buffers = nullptr;
-   }
+      /**
+       * @brief Content as up to two contiguous ranges, not caring about busy
+       *        producers
+       */
+      SSpans entrySpans() const;
 
-   #if ! IS_ENABLED( CONFIG_LEPTO_RING_DOWNSIZE )
-   // Don't mess with the duplicated range
-   lFullAssert( m_maxEntries < (0x7FFFFFFF / DUPLICATE_FACTOR ) );
-   #endif
-   
-   return;
-};
+      /**
+       * @brief Number of positions the indices run through
+       */
+      ringIndex_t duplicatedRange() const
+      {
+         #if IS_ENABLED( CONFIG_LEPTO_RING_DOWNSIZE )
+            return( m_maxEntries );
+         #else
+            return( m_maxEntriesDuplicated );
+         #endif
+      }
 
+      // Sorted search: "goes before the result" for lower/upper bound
+      template< bool UPPER, typename C >
+      static bool isBefore( const T& entry, const C& value )
+      {
+         return( UPPER ? !( value < entry ) : ( entry < value ) );
+      }
 
-template <typename T>
-CList<T>::~CList()
-{
-   if( m_buffers )
-   {
-      delete[] m_buffers;
-   }
+      template< bool UPPER, typename C >
+      static int searchSpan( const T* data, int size, const C& value );
+
+      /**
+       * @brief Sorted search over the first 'entries' entries
+       */
+      template< bool UPPER, typename C >
+      int bound( const C& value, int entries ) const;
+
+      /**
+       * @brief Front index as seen by producers for checking if the list is
+       *        full.
+       *
+       *        With CONFIG_LEPTO_RING_CACHELINE_SEPARATION the last seen front
+       *        index is used as long as 'needed' entries are free with it.
+       *        An outdated front index only makes the list look fuller, never
+       *        emptier.
+       */
+      ringIndex_t producerFront( ringIndex_t back, int needed = 1 )
+      {
+         #if IS_ENABLED( CONFIG_LEPTO_RING_CACHELINE_SEPARATION )
+            // Shared by all producers; only a hint, so relaxed is enough
+            ringIndex_t front=__atomic_load_n( &m_frontCache, __ATOMIC_RELAXED );
+            if( m_maxEntries &&
+                ( ( ( back + m_maxEntriesDuplicated - front ) MOD_DUPLICATED ) + needed > m_maxEntries ) )
+            {
+               front=__atomic_load_n( &m_frontPos, __ATOMIC_SEQ_CST );
+               __atomic_store_n( &m_frontCache, front, __ATOMIC_RELAXED );
+            }
+            return( front );
+         #else
+            (void)back;
+            (void)needed;
+            return( m_frontPos );
+         #endif
+      }
+
+      /**
+       * @brief Drop the front entry; the caller made sure there is one.
+       *        Also used by producers of volatile lists, which must not
+       *        reload the consumer's copy of the back index.
+       */
+      void discardFront()
+      {
+         destroyEntries( m_frontPos, 1 );
+         m_frontPos = ( m_frontPos + 1 ) MOD_DUPLICATED;
+      }
+
+      void resetIndexCaches()
+      {
+         #if IS_ENABLED( CONFIG_LEPTO_RING_CACHELINE_SEPARATION )
+            m_frontCache=m_frontPos;
+            m_backCache=m_backPos;
+         #endif
+      }
+
+      /**
+       * @brief Reserve an entry for push_back() and emplace_back(). Drops
+       *        the front on volatile lists and expands resizable ones.
+       * @return Index of the reserved entry or '-1'
+       */
+      ringIndex_t reserveBack();
+
+      /**
+       * @brief Get uninitialized storage for 'n' entries
+       * @return nullptr if the memory resource is exhausted
+       */
+      T* allocateEntries( int n )
+      {
+         if( m_resource )
+         {
+            return( (T*)m_resource->allocate( n * sizeof( T ), alignof( T ) ) );
+         }
+         #if defined( __cpp_aligned_new )
+            if( alignof( T ) > __STDCPP_DEFAULT_NEW_ALIGNMENT__ )
+            {
+               return( (T*)::operator new( n * sizeof( T ), std::align_val_t( alignof( T ) ) ) );
+            }
+         #endif
+         return( (T*)::operator new( n * sizeof( T ) ) );
+      }
+
+      void freeEntries( T* entries, int n )
+      {
+         if( m_resource )
+         {
+            m_resource->deallocate( entries, n * sizeof( T ), alignof( T ) );
+            return;
+         }
+         #if defined( __cpp_aligned_new )
+            if( alignof( T ) > __STDCPP_DEFAULT_NEW_ALIGNMENT__ )
+            {
+               ::operator delete( entries, std::align_val_t( alignof( T ) ) );
+               return;
+            }
+         #endif
+         ::operator delete( entries );
+      }
+
+      /**
+       * @brief Destroy 'n' entries starting at index 'pos'. The indices are
+       *        not touched.
+       */
+      void destroyEntries( ringIndex_t pos, int n )
+      {
+         if( !m_buffers )
+         {
+            return;
+         }
+         for( int i1=0; i1<n; i1++ )
+         {
+            m_buffers[ ( pos + i1 ) MOD_ENTRY ].~T();
+         }
+      }
+
+      /**
+       * @brief Copy construct 'n' entries into uninitialized 'dest'
+       */
+      static void constructEntries( T* dest, const T* src, int n )
+      {
+         if( n <= 0 )
+         {
+            return;
+         }
+         if( __is_trivially_copyable( T ) )
+         {
+            memcpy( (void*)dest, (const void*)src, n * sizeof( T ) );
+         }
+         else
+         {
+            for( int i1=0; i1<n; i1++ )
+            {
+               new( &dest[i1] ) T( src[i1] );
+            }
+         }
+      }
+
+      /**
+       * @brief Move 'n' entries into uninitialized 'dest'. The entries in
+       *        'src' are destroyed afterwards.
+       */
+      static void relocateEntries( T* dest, T* src, int n )
+      {
+         if( n <= 0 )
+         {
+            return;
+         }
+         if( __is_trivially_copyable( T ) )
+         {
+            memcpy( (void*)dest, (const void*)src, n * sizeof( T ) );
+         }
+         else
+         {
+            for( int i1=0; i1<n; i1++ )
+            {
+               new( &dest[i1] ) T( doMove( src[i1] ) );
+               src[i1].~T();
+            }
+         }
+      }
+
+      static void copyEntries( T* dest, const T* src, int n )
+      {
+         // An empty span may come with a nullptr, which memcpy() must not get
+         if( n <= 0 )
+         {
+            return;
+         }
+         if( __is_trivially_copyable( T ) )
+         {
+            memcpy( (void*)dest, (const void*)src, n * sizeof( T ) );
+         }
+         else
+         {
+            for( int i1=0; i1<n; i1++ )
+            {
+               dest[i1]=src[i1];
+            }
+         }
+      }
+
+      /**
+       * @brief Direct reference to entry
+       *        This is only used in inherited classes.
+       * @param pos: Real index to entry
+       * @return reference
+       */
+      T &rawEntry(ringIndex_t pos) const
+      {
+         lAssert( pos <= m_maxEntries );
+         return( m_buffers[ pos MOD_ENTRY ] );
+      }
+
+      #if IS_ENABLED( CONFIG_LEPTO_LIST_RESIZABLE )
+      bool expand( void );
+      #endif
+
+      void allocate( int size );
+
+};
+
+
+template <typename T>
+CList<T>::CList(int maxEntries, CMemoryResource* resource)
+   :m_frontPos(0)
+   ,m_backPos(0)
+   ,m_maxEntries(maxEntries)
+   ,m_resource(resource)
+   #if ! IS_ENABLED( CONFIG_LEPTO_RING_DOWNSIZE )
+   ,m_maxEntriesDuplicated( duplicatedEntries( maxEntries ) )
+   #endif
+   #if IS_ENABLED( CONFIG_LEPTO_RING_SUPPORT_VOLATILE )
+   ,m_volatile(false)
+   #endif
+{
+   if( m_maxEntries )
+   {
+      m_buffers=allocateEntries( m_maxEntries );
+      lFullAssert( m_buffers != nullptr );
+   }
+   else
+   {
+      m_buffers = nullptr;
+   }
+
+   return;
+};
+
+
+template <typename T>
+CList<T>::~CList()
+{
+   if( m_buffers )
+   {
+      destroyEntries( m_frontPos, count() );
+      freeEntries( m_buffers, m_maxEntries );
+   }
 
    m_buffers=nullptr;
 
@@ -683,9 +1338,9 @@ void CList<T>::vitalize()
 {
    lAssert( m_maxEntries == 0 );
    m_maxEntries = CONFIG_LEPTO_LIST_INCREMENT;
-   m_buffers=new T[ m_maxEntries ];
+   m_buffers=allocateEntries( m_maxEntries );
    #if ! IS_ENABLED( CONFIG_LEPTO_RING_DOWNSIZE )
-      m_maxEntriesDuplicated= m_maxEntries * DUPLICATE_FACTOR ;
+      m_maxEntriesDuplicated=duplicatedEntries( m_maxEntries );
    #endif
 }
 
@@ -694,7 +1349,12 @@ void CList<T>::vitalize()
 template <typename T>
 void CList<T>::clear()
 {
+   if( m_maxEntries )
+   {
+      destroyEntries( m_frontPos, count() );
+   }
    m_frontPos=m_backPos=0;
+   resetIndexCaches();
 }
 
 
@@ -705,7 +1365,7 @@ T CList<T>::pop()
 
    if( isDataAvailable() )
    {
-      value=*frontEntry();
+      value=doMove( *frontEntry() );
       dropFront();
    }
 
@@ -713,6 +1373,20 @@ T CList<T>::pop()
 };
 
 
+template <typename T>
+bool CList<T>::pop(T& value)
+{
+   if( ! isDataAvailable() )
+   {
+      return(false);
+   }
+   value=doMove( *frontEntry() );
+   dropFront();
+
+   return(true);
+};
+
+
 template <typename T>
 T *CList<T>::frontEntry() const
 {
@@ -748,7 +1422,7 @@ void CList<T>::dropFront()
 {
    if(isDataAvailableBasically())
    {
-      m_frontPos = ( m_frontPos + 1 ) MOD_DUPLICATED;
+      discardFront();
    }
    else
    {
@@ -760,7 +1434,133 @@ void CList<T>::dropFront()
 
 
 template <typename T>
-bool CList<T>::push_back(const T value)
+int CList<T>::pushBulk(const T* values, int n)
+{
+   bool valid;
+   ringIndex_t reserved;
+   int reservedCount;
+
+   #if CONFIG_LEPTO_RING_DEFAULT_SIZE == 0
+      if( m_maxEntries == 0 )
+      {
+         vitalize();
+      }
+   #endif
+
+   if( n <= 0 )
+   {
+      return( 0 );
+   }
+
+   #if ! IS_ENABLED( CONFIG_LEPTO_RING_NO_THREADS )
+      __atomic_add_fetch(&m_busyProducing, 1, __ATOMIC_SEQ_CST);
+   #endif
+
+   #if IS_ENABLED( CONFIG_LEPTO_LIST_RESIZABLE ) && ! IS_ENABLED( CONFIG_LEPTO_RING_NO_THREADS )
+      // Buffer is about to be exchanged. Behave like a full list.
+      if( __atomic_load_n( &m_expanding, __ATOMIC_SEQ_CST ) )
+      {
+         __atomic_sub_fetch(&m_busyProducing, 1, __ATOMIC_SEQ_CST);
+         return( 0 );
+      }
+   #endif
+
+   do{
+      reserved=m_backPos;
+      ringIndex_t front=producerFront( reserved, n );
+
+      if( isFull(front, reserved) )
+      {
+         #if ! IS_ENABLED( CONFIG_LEPTO_RING_NO_THREADS )
+            __atomic_sub_fetch(&m_busyProducing, 1, __ATOMIC_SEQ_CST);
+         #endif
+         return( 0 );
+      }
+      reservedCount=MIN( n, (int)m_maxEntries - distance( front, reserved ) - LEPTO_RING_SPARE_ENTRIES );
+      ringIndex_t nextBack=( reserved + reservedCount ) MOD_DUPLICATED;
+      valid=__atomic_compare_exchange_n( &m_backPos, &reserved, nextBack,
+                     true, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST );
+   }while(!valid);
+
+   ringIndex_t start=reserved MOD_ENTRY;
+   int firstCount=MIN( reservedCount, (int)( m_maxEntries - start ) );
+   constructEntries( &m_buffers[ start ], values, firstCount );
+   constructEntries( &m_buffers[ 0 ], values + firstCount, reservedCount - firstCount );
+
+   pushReserved( reserved );
+
+   return( reservedCount );
+}
+
+
+template <typename T>
+int CList<T>::popBulk(T* values, int n)
+{
+   if( n <= 0 )
+   {
+      return( 0 );
+   }
+
+   SSpans spans=readableSpans();
+   int firstCount=MIN( n, spans.first.size );
+   int secondCount=MIN( n - firstCount, spans.second.size );
+
+   copyEntries( values, spans.first.data, firstCount );
+   copyEntries( values + firstCount, spans.second.data, secondCount );
+   commit( firstCount + secondCount );
+
+   return( firstCount + secondCount );
+}
+
+
+template <typename T>
+typename CList<T>::SSpans CList<T>::readableSpans() const
+{
+   if( ! isDataAvailable() )
+   {
+      return( SSpans{ { nullptr, 0 }, { nullptr, 0 } } );
+   }
+
+   return( entrySpans() );
+}
+
+
+template <typename T>
+typename CList<T>::SSpans CList<T>::entrySpans() const
+{
+   SSpans spans{ { nullptr, 0 }, { nullptr, 0 } };
+   int entries=m_maxEntries ? count() : 0;
+
+   if( !entries )
+   {
+      return( spans );
+   }
+
+   ringIndex_t start=m_frontPos MOD_ENTRY;
+
+   spans.first.data=&m_buffers[ start ];
+   spans.first.size=MIN( entries, (int)( m_maxEntries - start ) );
+   if( entries > spans.first.size )
+   {
+      spans.second.data=&m_buffers[ 0 ];
+      spans.second.size=entries - spans.first.size;
+   }
+
+   return( spans );
+}
+
+
+template <typename T>
+void CList<T>::commit(int n)
+{
+   lAssert( ( n >= 0 ) && ( n <= count() ) );
+   destroyEntries( m_frontPos, n );
+   m_frontPos = ( m_frontPos + n ) MOD_DUPLICATED;
+}
+
+
+template <typename T>
+ringIndex_t CList<T>::reserveBack()
 {
    #if CONFIG_LEPTO_RING_DEFAULT_SIZE == 0
       if( m_maxEntries == 0 )
@@ -770,9 +1570,11 @@ bool CList<T>::push_back(const T value)
    #endif
    
    #if IS_ENABLED( CONFIG_LEPTO_RING_SUPPORT_VOLATILE )
-   if( isFull() && m_volatile )
+   // Check for data without the consumer's index cache; an empty list
+   // without entries is full as well
+   if( isFull() && m_volatile && ( m_backPos != m_frontPos ) )
    {
-      dropFront();
+      discardFront();
    }
    #endif // ? #if BIWAK_SUPPORT_VOLATILE_RING
    
@@ -783,11 +1585,14 @@ bool CList<T>::push_back(const T value)
       #if IS_ENABLED( CONFIG_LEPTO_LIST_RESIZABLE )
          if( m_resizable )
          {
-            expand();
-            if( (index=tryReserve()) == (ringIndex_t)-1 )
+            // Other producers may fill up the expanded list first
+            do
             {
-               return(false);
-            }
+               if( ! expand() )
+               {
+                  return(-1);
+               }
+            }while( (index=tryReserve()) == (ringIndex_t)-1 );
          }
          else
       #endif
@@ -795,10 +1600,39 @@ bool CList<T>::push_back(const T value)
          #if IS_ENABLED( CONFIG_LEPTO_LIST_ABORT_FAILING_PUSH )
             abort();
          #endif
-         return(false);
          }
    }
-   *reservedEntry(index)=value;
+
+   return(index);
+};
+
+
+template <typename T>
+bool CList<T>::push_back(const T& value)
+{
+   ringIndex_t index=reserveBack();
+
+   if( index == (ringIndex_t)-1 )
+   {
+      return(false);
+   }
+   new( reservedEntry(index) ) T( value );
+   pushReserved( index );
+
+   return(true);
+};
+
+
+template <typename T>
+bool CList<T>::push_back(T&& value)
+{
+   ringIndex_t index=reserveBack();
+
+   if( index == (ringIndex_t)-1 )
+   {
+      return(false);
+   }
+   new( reservedEntry(index) ) T( doMove(value) );
    pushReserved( index );
 
    return(true);
@@ -809,9 +1643,11 @@ template <typename T>
 bool CList<T>::push_nts(const T value)
 {
 #if IS_ENABLED( CONFIG_LEPTO_RING_SUPPORT_VOLATILE )
-   if( isFull() && m_volatile )
+   // Check for data without the consumer's index cache; an empty list
+   // without entries is full as well
+   if( isFull() && m_volatile && ( m_backPos != m_frontPos ) )
    {
-      dropFront();
+      discardFront();
    }
 #endif // ? #if BIWAK_SUPPORT_VOLATILE_RING
    
@@ -821,7 +1657,7 @@ bool CList<T>::push_nts(const T value)
    {
       return(false);
    }
-   *top=value;
+   new( top ) T( value );
    pushBack( );
    
    return(true);
@@ -829,20 +1665,18 @@ bool CList<T>::push_nts(const T value)
 
 
 template <typename T>
-T CList<T>::crosssum() const
+typename CList<T>::accumulator_t CList<T>::sum() const
 {
-   T value=0;
-   int pos=0;
-   int entryCount;
-   if(! ( entryCount = count() ) )
+   SSpans spans=entrySpans();
+   accumulator_t value=0;
+
+   for( int i1=0; i1<spans.first.size; i1++ )
    {
-      return(value);
+      value += spans.first.data[i1];
    }
-
-   for(int cnt=0; cnt< entryCount; cnt++)
+   for( int i1=0; i1<spans.second.size; i1++ )
    {
-      value += *getEntry(pos);
-      pos++;
+      value += spans.second.data[i1];
    }
 
    return( value );
@@ -850,17 +1684,80 @@ T CList<T>::crosssum() const
 
 
 template <typename T>
-T CList<T>::average() const
+typename CList<T>::accumulator_t CList<T>::mean() const
 {
-   T value=crosssum();
-   
+   SSpans spans=entrySpans();
+
    // in case there are no values at all, avoid division by zero.
-   if( !value )
+   if( !spans.size() )
    {
-      return(value);
+      return( 0 );
    }
-   
-   return( value / count() );
+
+   return( sum() / (accumulator_t)spans.size() );
+}
+
+
+template <typename T>
+T CList<T>::min() const
+{
+   SSpans spans=entrySpans();
+
+   if( !spans.size() )
+   {
+      return( T{} );
+   }
+
+   T value=spans.first.data[0];
+   for( int i1=1; i1<spans.first.size; i1++ )
+   {
+      value=( spans.first.data[i1] < value ) ? spans.first.data[i1] : value;
+   }
+   for( int i1=0; i1<spans.second.size; i1++ )
+   {
+      value=( spans.second.data[i1] < value ) ? spans.second.data[i1] : value;
+   }
+
+   return( value );
+}
+
+
+template <typename T>
+T CList<T>::max() const
+{
+   SSpans spans=entrySpans();
+
+   if( !spans.size() )
+   {
+      return( T{} );
+   }
+
+   T value=spans.first.data[0];
+   for( int i1=1; i1<spans.first.size; i1++ )
+   {
+      value=( value < spans.first.data[i1] ) ? spans.first.data[i1] : value;
+   }
+   for( int i1=0; i1<spans.second.size; i1++ )
+   {
+      value=( value < spans.second.data[i1] ) ? spans.second.data[i1] : value;
+   }
+
+   return( value );
+}
+
+
+template <typename T>
+T CList<T>::crosssum() const
+{
+   return( (T)sum() );
+}
+
+
+template <typename T>
+T CList<T>::average() const
+{
+   // Summed up in the wider type; no overflow for small integer types
+   return( (T)mean() );
 }
 
 
@@ -876,6 +1773,20 @@ T CList<T>::average() const
 template <typename T>
 bool CList<T>::isDataAvailableBasically() const
 {
+   #if IS_ENABLED( CONFIG_LEPTO_RING_CACHELINE_SEPARATION )
+      // Trust the last seen back index as long as it shows data. An outdated
+      // back index only makes the list look emptier.
+      if( m_maxEntries )
+      {
+         ringIndex_t used=( m_backCache + m_maxEntriesDuplicated - m_frontPos ) MOD_DUPLICATED;
+         if( used && ( used <= m_maxEntries ) )
+         {
+            return( true );
+         }
+      }
+      m_backCache=__atomic_load_n( &m_backPos, __ATOMIC_SEQ_CST );
+   #endif
+
    return( m_backPos != m_frontPos );
 }
 
@@ -924,14 +1835,6 @@ const T *CList<T>::putString(const T *str)
 };
 
 
-template <typename T>
-typename CList<T>::CIterator& CList<T>::CIterator::operator +=(int number)
-{
-   lDebugAssert( number );
-   m_pos = ( m_pos + number ) MOD_DUPLICATED_ITERATOR;
-   return( *this );
-};
-
 #if IS_ENABLED( CONFIG_LEPTO_LIST_RESIZABLE )
 
 template <typename T>
@@ -942,20 +1845,74 @@ bool CList<T>::expand( )
       return(false);
    }
 
+   #if ! IS_ENABLED( CONFIG_LEPTO_RING_NO_THREADS )
+      int idle=0;
+      if( ! __atomic_compare_exchange_n( &m_expanding, &idle, 1, false,
+                                         __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST ) )
+      {
+         // An other producer is expanding. Just wait for it.
+         while( __atomic_load_n( &m_expanding, __ATOMIC_SEQ_CST ) )
+         {
+            CONFIG_LEPTO_RING_RELAX();
+         }
+         return(true);
+      }
+
+      // New reservations are refused now. Let producers that already
+      // reserved an entry finish writing to the old buffer.
+      while( __atomic_load_n( &m_busyProducing, __ATOMIC_SEQ_CST ) )
+      {
+         CONFIG_LEPTO_RING_RELAX();
+      }
+
+      // A late producer; the list has been expanded or drained meanwhile
+      if( ! isFull() )
+      {
+         __atomic_store_n( &m_expanding, 0, __ATOMIC_SEQ_CST );
+         return(true);
+      }
+   #endif
+
+   ringIndex_t oldMaxEntries=m_maxEntries;
    T *oldBuffers=m_buffers;
    int size=count();
-   m_maxEntries+= CONFIG_LEPTO_LIST_INCREMENT;
-   m_buffers=new T[ m_maxEntries ];
-   lFullAssert( m_buffers != nullptr );
+   ringIndex_t start=oldMaxEntries ? ( m_frontPos MOD_ENTRY ) : 0;
+   ringIndex_t newMaxEntries=oldMaxEntries + CONFIG_LEPTO_LIST_INCREMENT;
+
+   if( m_growth == EListGrowth::Geometric )
+   {
+      newMaxEntries=MAX( newMaxEntries, oldMaxEntries * 2 );
+   }
 
-   for(int i1=0; i1<size; i1++)
+   T *newBuffers=allocateEntries( newMaxEntries );
+   if( ! newBuffers )
    {
-      m_buffers[i1]=oldBuffers[ (i1+m_frontPos) MOD_ENTRY ];
+      // Memory resource is exhausted; keep the old buffer
+      #if ! IS_ENABLED( CONFIG_LEPTO_RING_NO_THREADS )
+         __atomic_store_n( &m_expanding, 0, __ATOMIC_SEQ_CST );
+      #endif
+      return(false);
    }
 
-   delete[](oldBuffers);
+   // Two contiguous segments: front till end of buffer and begin till back
+   int firstCount=MIN( size, (int)( oldMaxEntries - start ) );
+   relocateEntries( newBuffers, &oldBuffers[ start ], firstCount );
+   relocateEntries( newBuffers + firstCount, oldBuffers, size - firstCount );
+
+   m_buffers=newBuffers;
+   m_maxEntries=newMaxEntries;
+   #if ! IS_ENABLED( CONFIG_LEPTO_RING_DOWNSIZE )
+      m_maxEntriesDuplicated=duplicatedEntries( m_maxEntries );
+   #endif
    m_frontPos=0;
    m_backPos=size;
+   resetIndexCaches();
+
+   freeEntries( oldBuffers, oldMaxEntries );
+
+   #if ! IS_ENABLED( CONFIG_LEPTO_RING_NO_THREADS )
+      __atomic_store_n( &m_expanding, 0, __ATOMIC_SEQ_CST );
+   #endif
 
    return(true);
 };
@@ -967,9 +1924,9 @@ template <typename T>
 void CList<T>::allocate( int size )
 {
    m_maxEntries = size;
-   m_buffers=new T[ m_maxEntries ];
+   m_buffers=allocateEntries( m_maxEntries );
    #if ! IS_ENABLED( CONFIG_LEPTO_RING_DOWNSIZE )
-   m_maxEntriesDuplicated= m_maxEntries * DUPLICATE_FACTOR;
+   m_maxEntriesDuplicated=duplicatedEntries( m_maxEntries );
    #endif
 }
 
@@ -977,43 +1934,110 @@ void CList<T>::allocate( int size )
 template <typename T> template<typename C>
 typename CList<T>::CIterator CList<T>::find(const C& candidate)
 {
-   CIterator front( this, m_frontPos );
-   CIterator back( this, m_backPos );
-   CIterator mid(this, 0);
-   #if 0
-   int steps=0;
-   #endif
+   int first=0;
+   int size=count();
 
-   while( distance(front, back) > 1 )
+   // Halves 'size' every step; no chance to loop forever
+   while( size > 0 )
    {
-      mid=(front.getIndex() +(distance( front.getIndex(), back.getIndex() ) /2 ) ) % m_maxEntries;
-      //printf("   Check: Front: 0x%X; Back: 0x%X; distance: %d; value: 0x%X\n", front.getIndex(), back.getIndex(), distance(front, back), candidate );
-      if( mid < candidate )
+      int half=size / 2;
+
+      if( at( first + half ) < candidate )
       {
-         right(front, mid, back);
+         first+=half + 1;
+         size-=half + 1;
       }
       else
       {
-         left(front, mid, back);
+         size=half;
       }
-      #if 0
-      steps++;
-      if(steps>1000)
-      {
-         lFatal("");
-      }
-      #endif
    }
 
-   // printf("   Front: 0x%X; Back: 0x%X; distance: %d; value: 0x%X\n", front.getIndex(), back.getIndex(), distance(front, back), candidate );
-   if( front < candidate )
+   return( at( first ) );
+}
+
+
+template <typename T> template< bool UPPER, typename C >
+int CList<T>::searchSpan( const T* data, int size, const C& value )
+{
+   const T* base=data;
+
+   if( !size )
+   {
+      return( 0 );
+   }
+
+   while( size > 1 )
+   {
+      int half=size / 2;
+
+      // No branch to mispredict; becomes a conditional move
+      base=isBefore<UPPER>( base[ half ], value ) ? base + half : base;
+      size-=half;
+   }
+
+   return( (int)( base - data ) + isBefore<UPPER>( *base, value ) );
+}
+
+
+template <typename T> template< bool UPPER, typename C >
+int CList<T>::bound( const C& value, int entries ) const
+{
+   SSpans spans=entrySpans();
+
+   // Pseudo lists without data can only use find()
+   lAssert( m_buffers || !entries );
+   lAssert( entries <= spans.size() );
+   if( spans.first.size >= entries )
+   {
+      spans.first.size=entries;
+      spans.second.size=0;
+   }
+   else
+   {
+      spans.second.size=entries - spans.first.size;
+   }
+
+   // Only one of the parts has to be searched
+   if( spans.second.size
+       && isBefore<UPPER>( spans.first.data[ spans.first.size - 1 ], value ) )
+   {
+      return( spans.first.size
+              + searchSpan<UPPER>( spans.second.data, spans.second.size, value ) );
+   }
+
+   return( searchSpan<UPPER>( spans.first.data, spans.first.size, value ) );
+}
+
+
+template <typename T>
+bool CList<T>::insertSorted(const T& value)
+{
+   if( ! push_back( value ) )
+   {
+      return( false );
+   }
+
+   // The front may have been dropped on volatile lists; search afterwards
+   int last=count() - 1;
+   ringIndex_t dest=( m_frontPos + last ) MOD_ENTRY;
+   int pos=bound<true>( m_buffers[ dest ], last );
+
+   if( pos == last )
+   {
+      return( true );
+   }
+
+   T pushed( doMove( m_buffers[ dest ] ) );
+   for( int i1=last; i1>pos; i1-- )
    {
-      //printf("   F\n");
-      return( back );
+      ringIndex_t source=dest ? ( dest - 1 ) : ( m_maxEntries - 1 );
+      m_buffers[ dest ]=doMove( m_buffers[ source ] );
+      dest=source;
    }
+   m_buffers[ dest ]=doMove( pushed );
 
-   //printf("   B\n");
-   return( front );
+   return( true );
 }
 
 // Who knows... sometime someone might want to debug. Some tests actually use this
@@ -0,0 +1,278 @@
+#ifndef LEPTO_LOSSY_RING_HPP
+#define LEPTO_LOSSY_RING_HPP
+/**---------------------------------------------------------------------------
+ *
+ * @file    lossyRing.hpp
+ * @brief   Ring buffer that overwrites the oldest entries when full
+ *
+ * Meant for telemetry: producers never fail or block on a full ring, the
+ * newest entries win. Unlike a volatile CList (setVolatile()) the producers
+ * do not move the front index; they only claim positions by an atomic
+ * increment of m_backPos. Any number of producers, one consumer.
+ *
+ * Every slot is a sequence lock. Its stamp for position 'pos':
+ *    2 * pos + 1          producer of 'pos' is writing the slot
+ *    2 * pos + 2          entry of 'pos' is published
+ * A producer takes the slot over from older positions only. One that got
+ * lapped before starting to write gives up; its entry counts as dropped.
+ *
+ * The consumer copies an entry out and checks the stamp again afterwards,
+ * so torn entries are never returned. Positions that were overwritten
+ * before the consumer got to them are skipped and counted; see
+ * getDropped().
+ *
+ * Entries have to be trivially copyable. The capacity has to be a power of
+ * two.
+ *
+ * Example:
+ *    CLossyRing<STelemetry> ring(256);
+ *    ring << sample;                                 // Any thread
+ *
+ *    STelemetry sample;
+ *    while( ring.pop( sample ) ) { ... }             // Consumer thread
+ *    printf( "Lost: %u\n", ring.getDropped() );
+ *
+ * @date   20261017
+ * @author Maximilian Seesslen <src@seesslen.net>
+ * @copyright SPDX-License-Identifier: Apache-2.0
+ *
+ *--------------------------------------------------------------------------*/
+
+
+/*--- Includes -------------------------------------------------------------*/
+
+
+#include <lepto/list.hpp>     // ringIndex_t, configs
+
+
+/*--- Definitions ----------------------------------------------------------*/
+
+
+/**
+ * @brief Copy an entry that may be written concurrently, by relaxed atomic
+ *        accesses; word by word if possible. The result has to be checked
+ *        by a sequence lock.
+ */
+template <typename T>
+void relaxedCopy( void* dest, const void* src )
+{
+   if( ( ( sizeof( T ) % sizeof( unsigned int ) ) == 0 )
+       && ( alignof( T ) >= alignof( unsigned int ) ) )
+   {
+      for( unsigned int i1=0; i1 < sizeof( T ) / sizeof( unsigned int ); i1++ )
+      {
+         __atomic_store_n( &( (unsigned int*)dest )[i1],
+                           __atomic_load_n( &( (const unsigned int*)src )[i1], __ATOMIC_RELAXED ),
+                           __ATOMIC_RELAXED );
+      }
+   }
+   else
+   {
+      for( unsigned int i1=0; i1 < sizeof( T ); i1++ )
+      {
+         __atomic_store_n( &( (unsigned char*)dest )[i1],
+                           __atomic_load_n( &( (const unsigned char*)src )[i1], __ATOMIC_RELAXED ),
+                           __ATOMIC_RELAXED );
+      }
+   }
+}
+
+
+template <typename T>
+class CLossyRing
+{
+   static_assert( __is_trivially_copyable( T ), "Entries are copied while they may change" );
+
+   private:
+      struct SSlot
+      {
+         ringIndex_t stamp;
+         alignas( T ) unsigned char data[ sizeof( T ) ];
+      };
+
+      SSlot* m_slots;
+      ringIndex_t m_mask;
+      LEPTO_RING_CACHELINE_ALIGNED ringIndex_t m_frontPos;
+      unsigned int m_dropped;
+      LEPTO_RING_CACHELINE_ALIGNED ringIndex_t m_backPos;
+
+      static int diff( ringIndex_t a, ringIndex_t b )
+      {
+         return( (int)( a - b ) );
+      }
+
+      static ringIndex_t writing( ringIndex_t pos )
+      {
+         return( 2 * pos + 1 );
+      }
+
+      static ringIndex_t published( ringIndex_t pos )
+      {
+         return( 2 * pos + 2 );
+      }
+
+      void skip( ringIndex_t pos, unsigned int entries )
+      {
+         __atomic_add_fetch( &m_dropped, entries, __ATOMIC_RELAXED );
+         __atomic_store_n( &m_frontPos, pos + entries, __ATOMIC_RELAXED );
+      }
+
+   public:
+
+      CLossyRing( int maxEntries )
+         :m_slots( new SSlot[ maxEntries ] )
+         ,m_mask( maxEntries - 1 )
+         ,m_frontPos( 0 )
+         ,m_dropped( 0 )
+         ,m_backPos( 0 )
+      {
+         lAssert( maxEntries && ( ( maxEntries & ( maxEntries - 1 ) ) == 0 ) );
+         for( int i1=0; i1<maxEntries; i1++ )
+         {
+            // Published one lap before position 0
+            m_slots[i1].stamp=published( i1 - maxEntries );
+         }
+      }
+
+      ~CLossyRing()
+      {
+         delete[] m_slots;
+         m_slots=nullptr;
+      }
+
+      CLossyRing( const CLossyRing& ) = delete;
+      CLossyRing& operator=( const CLossyRing& ) = delete;
+
+      int getMaxEntries() const
+      {
+         return( m_mask + 1 );
+      }
+
+      /**
+       * @brief  Number of entries not popped yet; at most getMaxEntries().
+       *         Only a snapshot when other threads are active.
+       */
+      int count() const
+      {
+         int entries=diff( __atomic_load_n( &m_backPos, __ATOMIC_RELAXED ),
+                           __atomic_load_n( &m_frontPos, __ATOMIC_RELAXED ) );
+         return( MAX( 0, MIN( entries, getMaxEntries() ) ) );
+      }
+
+      bool isDataAvailable() const
+      {
+         return( count() > 0 );
+      }
+
+      /**
+       * @brief  Number of entries that were overwritten before they could be
+       *         popped. Can be read from any thread.
+       */
+      unsigned int getDropped() const
+      {
+         return( __atomic_load_n( &m_dropped, __ATOMIC_RELAXED ) );
+      }
+
+      /**
+       * @brief   Push an entry; overwrites the oldest one when the ring is
+       *          full. Thread safe for any number of producers. Waits while
+       *          a producer one lap behind is still writing the same slot.
+       * @return  false if newer entries already took over the slot; the
+       *          entry is dropped then
+       */
+      bool push_back( const T& value )
+      {
+         ringIndex_t pos=__atomic_fetch_add( &m_backPos, 1, __ATOMIC_RELAXED );
+         SSlot& slot=m_slots[ pos & m_mask ];
+         ringIndex_t stamp=__atomic_load_n( &slot.stamp, __ATOMIC_RELAXED );
+
+         while( true )
+         {
+            if( diff( stamp, writing( pos ) ) >= 0 )
+            {
+               // Lapped
+               return( false );
+            }
+            if( stamp & 1 )
+            {
+               // Older producer still writing; it may be preempted
+               CONFIG_LEPTO_RING_RELAX();
+               stamp=__atomic_load_n( &slot.stamp, __ATOMIC_RELAXED );
+               continue;
+            }
+            if( __atomic_compare_exchange_n( &slot.stamp, &stamp, writing( pos ),
+                  true, __ATOMIC_RELAXED, __ATOMIC_RELAXED ) )
+            {
+               break;
+            }
+         }
+
+         // The odd stamp has to be visible before any data
+         __atomic_thread_fence( __ATOMIC_RELEASE );
+         relaxedCopy<T>( slot.data, &value );
+         __atomic_store_n( &slot.stamp, published( pos ), __ATOMIC_RELEASE );
+
+         return( true );
+      }
+
+      CLossyRing& operator << ( const T& value )
+      {
+         push_back( value );
+         return( *this );
+      }
+
+      /**
+       * @brief   Pop the oldest entry still available. Only one consumer.
+       *          Overwritten entries on the way are skipped and counted.
+       * @return  false if no entry is available or the producer of the next
+       *          one is not done yet
+       */
+      bool pop( T& value )
+      {
+         alignas( T ) unsigned char buffer[ sizeof( T ) ];
+
+         while( true )
+         {
+            ringIndex_t back=__atomic_load_n( &m_backPos, __ATOMIC_RELAXED );
+            ringIndex_t pos=m_frontPos;
+
+            if( pos == back )
+            {
+               return( false );
+            }
+            if( diff( back, pos ) > getMaxEntries() )
+            {
+               // The producers lapped the consumer
+               skip( pos, back - getMaxEntries() - pos );
+               continue;
+            }
+
+            SSlot& slot=m_slots[ pos & m_mask ];
+            ringIndex_t stamp=__atomic_load_n( &slot.stamp, __ATOMIC_ACQUIRE );
+            int dif=diff( stamp, published( pos ) );
+
+            if( dif < 0 )
+            {
+               // Not written yet
+               return( false );
+            }
+            if( dif == 0 )
+            {
+               relaxedCopy<T>( buffer, slot.data );
+               __atomic_thread_fence( __ATOMIC_ACQUIRE );
+               if( __atomic_load_n( &slot.stamp, __ATOMIC_RELAXED ) == stamp )
+               {
+                  memcpy( (void*)&value, buffer, sizeof( T ) );
+                  __atomic_store_n( &m_frontPos, pos + 1, __ATOMIC_RELAXED );
+                  return( true );
+               }
+            }
+            // Overwritten while or before copying
+            skip( pos, 1 );
+         }
+      }
+};
+
+
+/*--- Fin ------------------------------------------------------------------*/
+#endif // ? ! LEPTO_LOSSY_RING_HPP
@@ -0,0 +1,272 @@
+#ifndef LEPTO_MEMORY_RESOURCE_HPP
+#define LEPTO_MEMORY_RESOURCE_HPP
+/**---------------------------------------------------------------------------
+ *
+ * @file    memoryResource.hpp
+ * @brief   Memory resources for the storage of lists and rings
+ *
+ * By default CList, CRing, CSpscRing, CBufferRing, CRecordRing and CBufferPool
+ * take their storage from global new/delete. A memory resource can be passed
+ * to the constructor instead to place the storage somewhere else:
+ *
+ *    CStaticBufferResource  Bump allocator on a buffer given by the user,
+ *                           e.g. a static array or shared memory.
+ *    CMonotonicResource     Arena which grows in chunks and frees everything
+ *                           at once when destroyed.
+ *    CHugePageResource      Every allocation is backed by huge pages (linux).
+ *
+ * The resource has to outlive all lists using it. The lists only call the
+ * resource when allocating, expanding and destroying; never when pushing or
+ * popping.
+ *
+ * Example:
+ *    static char storage[ 4096 ];
+ *    CStaticBufferResource resource( storage, sizeof( storage ) );
+ *    CRing<int> fifo( 100, &resource );
+ *
+ * @date   20261017
+ * @author Maximilian Seesslen <src@seesslen.net>
+ * @copyright SPDX-License-Identifier: Apache-2.0
+ *
+ *--------------------------------------------------------------------------*/
+
+
+/*--- Includes -------------------------------------------------------------*/
+
+
+#include <stddef.h>        // size_t
+#include <stdint.h>        // uintptr_t
+#include <lepto/lepto.h>   // IS_ENABLED
+#include <lepto/log.h>     // lAssert
+#include <new>             // align_val_t
+
+
+/*--- Definitions ----------------------------------------------------------*/
+
+
+class CMemoryResource
+{
+   public:
+      virtual ~CMemoryResource() {}
+
+      /**
+       * @return Pointer to 'size' bytes aligned to 'alignment' or nullptr
+       *         if the resource is exhausted
+       */
+      virtual void* allocate( size_t size, size_t alignment ) = 0;
+      virtual void deallocate( void* p, size_t size, size_t alignment ) = 0;
+
+   protected:
+      static uintptr_t alignUp( uintptr_t value, size_t alignment )
+      {
+         return( ( value + alignment - 1 ) & ~(uintptr_t)( alignment - 1 ) );
+      }
+};
+
+
+/**
+ * @brief Hands out a fixed buffer from front to back. Only the most recent
+ *        allocation can be given back. Thread safe.
+ */
+class CStaticBufferResource: public CMemoryResource
+{
+   private:
+      char* m_buffer;
+      size_t m_size;
+      size_t m_used;
+
+   public:
+      CStaticBufferResource( void* buffer, size_t size )
+         :m_buffer( (char*)buffer )
+         ,m_size( size )
+         ,m_used( 0 )
+      {
+      }
+
+      void* allocate( size_t size, size_t alignment ) override;
+      void deallocate( void* p, size_t size, size_t alignment ) override;
+
+      size_t getUsed() const
+      {
+         return( __atomic_load_n( &m_used, __ATOMIC_RELAXED ) );
+      }
+
+      size_t getSize() const
+      {
+         return( m_size );
+      }
+
+      /**
+       * @brief Forget all allocations. No list may use the buffer any more.
+       */
+      void release()
+      {
+         __atomic_store_n( &m_used, 0, __ATOMIC_RELAXED );
+      }
+};
+
+
+/**
+ * @brief Arena that grows in chunks taken from an upstream resource (or
+ *        new/delete). Single allocations are never given back; all chunks
+ *        are freed by release() or the destructor. Not thread safe.
+ */
+class CMonotonicResource: public CMemoryResource
+{
+   private:
+      struct SChunk
+      {
+         SChunk* next;
+         size_t size;
+      };
+
+      CMemoryResource* m_upstream;
+      size_t m_chunkSize;
+      SChunk* m_chunks;
+      char* m_current;
+      size_t m_left;
+
+      void* allocateUpstream( size_t size );
+      void freeUpstream( void* p, size_t size );
+
+   public:
+      CMonotonicResource( size_t chunkSize = 4096, CMemoryResource* upstream = nullptr )
+         :m_upstream( upstream )
+         ,m_chunkSize( chunkSize )
+         ,m_chunks( nullptr )
+         ,m_current( nullptr )
+         ,m_left( 0 )
+      {
+      }
+
+      /**
+       * @brief Start with 'buffer' and only take chunks from upstream when
+       *        it is used up. Further chunks have the size of the buffer.
+       *        The buffer itself is never freed.
+       */
+      CMonotonicResource( void* buffer, size_t size, CMemoryResource* upstream = nullptr )
+         :CMonotonicResource( size, upstream )
+      {
+         m_current=(char*)buffer;
+         m_left=size;
+      }
+
+      ~CMonotonicResource()
+      {
+         release();
+      }
+
+      CMonotonicResource( const CMonotonicResource& ) = delete;
+      CMonotonicResource& operator=( const CMonotonicResource& ) = delete;
+
+      void* allocate( size_t size, size_t alignment ) override;
+      void deallocate( void* p, size_t size, size_t alignment ) override;
+
+      /**
+       * @brief Free all chunks. No list may use the arena any more.
+       */
+      void release();
+};
+
+
+/**
+ * @brief  Aligned memory from 'resource', or from global new if it is
+ *         nullptr. Give it back by leptoDeallocate() with the same arguments.
+ */
+inline void* leptoAllocate( CMemoryResource* resource, size_t size, size_t alignment )
+{
+   if( resource )
+   {
+      return( resource->allocate( size, alignment ) );
+   }
+   #if defined( __cpp_aligned_new )
+      if( alignment > __STDCPP_DEFAULT_NEW_ALIGNMENT__ )
+      {
+         return( ::operator new( size, std::align_val_t( alignment ) ) );
+      }
+   #endif
+   return( ::operator new( size ) );
+}
+
+inline void leptoDeallocate( CMemoryResource* resource, void* p, size_t size, size_t alignment )
+{
+   if( resource )
+   {
+      resource->deallocate( p, size, alignment );
+      return;
+   }
+   #if defined( __cpp_aligned_new )
+      if( alignment > __STDCPP_DEFAULT_NEW_ALIGNMENT__ )
+      {
+         ::operator delete( p, std::align_val_t( alignment ) );
+         return;
+      }
+   #endif
+   ::operator delete( p );
+}
+
+/**
+ * @brief  Distance of buffers of 'size' bytes placed back to back in an arena
+ *         so every buffer keeps 'alignment'. The alignment has to be a power
+ *         of two; 0 would give a stride of 0 and all buffers would overlap.
+ */
+inline size_t leptoStride( size_t size, size_t alignment )
+{
+   lAssert( alignment && ( ( alignment & ( alignment - 1 ) ) == 0 ) );
+   return( ( size + alignment - 1 ) & ~( alignment - 1 ) );
+}
+
+
+#if defined( __linux__ )
+
+/**
+ * @brief Maps every allocation separately with huge pages. Falls back to
+ *        transparent huge pages when no huge pages are reserved in the
+ *        system (vm.nr_hugepages). Thread safe.
+ */
+class CHugePageResource: public CMemoryResource
+{
+   private:
+      size_t m_pageSize;
+      int m_hugeMappings;
+      int m_fallbackMappings;
+
+      size_t mappingSize( size_t size ) const
+      {
+         return( alignUp( size, m_pageSize ) );
+      }
+
+   public:
+      CHugePageResource( size_t pageSize = 2 * 1024 * 1024 )
+         :m_pageSize( pageSize )
+         ,m_hugeMappings( 0 )
+         ,m_fallbackMappings( 0 )
+      {
+      }
+
+      void* allocate( size_t size, size_t alignment ) override;
+      void deallocate( void* p, size_t size, size_t alignment ) override;
+
+      /**
+       * @brief Number of allocations that got explicit huge pages
+       */
+      int getHugeMappings() const
+      {
+         return( __atomic_load_n( &m_hugeMappings, __ATOMIC_RELAXED ) );
+      }
+
+      /**
+       * @brief Number of allocations that fell back to regular pages with
+       *        the transparent huge page hint
+       */
+      int getFallbackMappings() const
+      {
+         return( __atomic_load_n( &m_fallbackMappings, __ATOMIC_RELAXED ) );
+      }
+};
+
+#endif // ? __linux__
+
+
+/*--- Fin ------------------------------------------------------------------*/
+#endif // ? ! LEPTO_MEMORY_RESOURCE_HPP
@@ -0,0 +1,333 @@
+#ifndef LEPTO_RECORD_RING_HPP
+#define LEPTO_RECORD_RING_HPP
+/**---------------------------------------------------------------------------
+ *
+ * @file    recordRing.hpp
+ * @brief   Byte ring of variable-length records
+ *
+ * CBufferRing spends getMaxBufferSize() bytes on every buffer, no matter how
+ * much of it is used. CRecordRing packs records of any size back to back,
+ * each one prefixed by its length:
+ *
+ *    | len | payload..  | len | payload | PAD | ...unused...  |
+ *    ^-- m_frontPos                      ^-- m_backPos
+ *
+ * A record is never split. When it does not fit in front of the end of the
+ * memory, the rest of it is marked as padding and the record starts at the
+ * beginning. Records up to getMaxRecordSize() bytes always fit into an
+ * empty ring.
+ *
+ * Records are written and read in place:
+ *    reserve(n)  Producer; room for up to n bytes
+ *    commit(n)   Producer; publish the record with the n bytes used
+ *    peek()      Consumer; oldest record
+ *    release()   Consumer; drop the oldest record
+ *
+ * Every record starts at a multiple of CONFIG_LEPTO_RECORD_RING_ALIGNMENT.
+ * The size has to be a power of two.
+ *
+ * Wait-free for one producer and one consumer, like CSpscRing.
+ *
+ * Example:
+ *    CRecordRing ring( 4096 );
+ *    char* text=(char*)ring.reserve( 80 );           // Producer
+ *    if( text )
+ *    {
+ *       ring.commit( snprintf( text, 80, "Level: %d", level ) + 1 );
+ *    }
+ *
+ *    SRecord record=ring.peek();                     // Consumer
+ *    if( record.data )
+ *    {
+ *       puts( (const char*)record.data );
+ *       ring.release();
+ *    }
+ *
+ * @date   20261017
+ * @author Maximilian Seesslen <src@seesslen.net>
+ * @copyright SPDX-License-Identifier: Apache-2.0
+ *
+ *--------------------------------------------------------------------------*/
+
+
+/*--- Includes -------------------------------------------------------------*/
+
+
+#include <lepto/list.hpp>     // ringIndex_t, configs, CMemoryResource
+#include <string.h>           // memcpy
+
+
+/*--- Defines --------------------------------------------------------------*/
+
+
+#if ! defined CONFIG_LEPTO_RECORD_RING_ALIGNMENT
+   #define CONFIG_LEPTO_RECORD_RING_ALIGNMENT      4
+#endif
+
+
+/*--- Definitions ----------------------------------------------------------*/
+
+
+/**
+ * @brief Record handed out for reading in place
+ */
+struct SRecord
+{
+   const void* data;
+   int size;
+};
+
+
+class CRecordRing
+{
+   public:
+      static constexpr int ALIGNMENT = CONFIG_LEPTO_RECORD_RING_ALIGNMENT;
+
+   private:
+      static_assert( ( ALIGNMENT >= (int)sizeof( ringIndex_t ) )
+                     && ( ( ALIGNMENT & ( ALIGNMENT - 1 ) ) == 0 ),
+                     "The alignment has to be a power of two and hold the length" );
+
+      // Length of a padding record; it reaches up to the end of the memory
+      static constexpr ringIndex_t PADDING = ~(ringIndex_t)0;
+
+      // The length prefix takes one alignment unit
+      static constexpr ringIndex_t HEADER = ALIGNMENT;
+
+      unsigned char* m_data;
+      CMemoryResource* m_resource;
+      ringIndex_t m_mask;
+      ringIndex_t m_frontPos;       // Written by consumer only
+      ringIndex_t m_backPos;        // Written by producer only
+      ringIndex_t m_reservedPos;    // Producer only
+      int m_reservedSize;           // Producer only; -1 if nothing reserved
+
+      static ringIndex_t recordSize( ringIndex_t size )
+      {
+         return( HEADER + ( ( size + ALIGNMENT - 1 ) & ~( ALIGNMENT - 1 ) ) );
+      }
+
+      ringIndex_t& length( ringIndex_t pos ) const
+      {
+         return( *(ringIndex_t*)&m_data[ pos & m_mask ] );
+      }
+
+      ringIndex_t loadFront() const
+      {
+         return( __atomic_load_n( &m_frontPos, __ATOMIC_ACQUIRE ) );
+      }
+
+      ringIndex_t loadBack() const
+      {
+         return( __atomic_load_n( &m_backPos, __ATOMIC_ACQUIRE ) );
+      }
+
+      /**
+       * @brief  Position of the first real record from 'pos' on. A padding
+       *         record is always published together with the record behind
+       *         it.
+       */
+      ringIndex_t skipPadding( ringIndex_t pos ) const
+      {
+         if( length( pos ) == PADDING )
+         {
+            pos+=getSize() - ( pos & m_mask );
+         }
+         return( pos );
+      }
+
+   public:
+
+      /**
+       * @param size: Bytes of memory; a power of two
+       * @param resource: Where to take the memory from; nullptr for global
+       *        new/delete
+       */
+      CRecordRing( int size, CMemoryResource* resource = nullptr )
+         :m_resource( resource )
+         ,m_mask( size - 1 )
+         ,m_frontPos( 0 )
+         ,m_backPos( 0 )
+         ,m_reservedPos( 0 )
+         ,m_reservedSize( -1 )
+      {
+         lAssert( ( size >= 2 * ALIGNMENT ) && ( ( size & ( size - 1 ) ) == 0 ) );
+         m_data=(unsigned char*)leptoAllocate( m_resource, size, ALIGNMENT );
+         lFullAssert( m_data != nullptr );
+      }
+
+      ~CRecordRing()
+      {
+         leptoDeallocate( m_resource, m_data, getSize(), ALIGNMENT );
+         m_data=nullptr;
+      }
+
+      CRecordRing( const CRecordRing& ) = delete;
+      CRecordRing& operator=( const CRecordRing& ) = delete;
+
+      /**
+       * @brief  Reset the ring. Neither producer nor consumer may be active.
+       */
+      void clear()
+      {
+         m_frontPos=m_backPos=0;
+         m_reservedSize=-1;
+      }
+
+      /**
+       * @brief  Bytes of memory including length prefixes and padding
+       */
+      int getSize() const
+      {
+         return( m_mask + 1 );
+      }
+
+      /**
+       * @brief  Biggest record that fits into an empty ring in any case
+       */
+      int getMaxRecordSize() const
+      {
+         return( getSize() / 2 - HEADER );
+      }
+
+      /**
+       * @brief  Bytes in use including length prefixes and padding
+       */
+      int getUsed() const
+      {
+         return( (int)( loadBack() - loadFront() ) );
+      }
+
+      bool isDataAvailable() const
+      {
+         return( loadBack() != m_frontPos );
+      }
+
+      //--- Producer side ---------------------------------------------------
+
+      /**
+       * @brief  Reserve room for a record of up to 'size' bytes. Nothing is
+       *         visible to the consumer before commit(). Reserving again
+       *         replaces the previous reservation.
+       * @return Where to write the record; nullptr if there is not enough
+       *         contiguous space
+       */
+      void* reserve( int size )
+      {
+         ringIndex_t need=recordSize( size );
+         ringIndex_t back=m_backPos;
+         ringIndex_t free=getSize() - ( back - loadFront() );
+         ringIndex_t tail=getSize() - ( back & m_mask );
+         ringIndex_t padding=( need > tail ) ? tail : 0;
+
+         lAssert( size >= 0 );
+         if( padding + need > free )
+         {
+            return( nullptr );
+         }
+         if( padding )
+         {
+            // Only published by commit()
+            length( back )=PADDING;
+         }
+         m_reservedPos=back + padding;
+         m_reservedSize=size;
+
+         return( &m_data[ ( m_reservedPos + HEADER ) & m_mask ] );
+      }
+
+      /**
+       * @brief  Publish the reserved record with its final size; may be
+       *         less than reserved. A negative size, e.g. the error of
+       *         snprintf(), cancels the reservation.
+       */
+      void commit( int size )
+      {
+         lAssert( ( m_reservedSize >= 0 ) && ( size <= m_reservedSize ) );
+         if( size < 0 )
+         {
+            m_reservedSize=-1;
+            return;
+         }
+         length( m_reservedPos )=size;
+         m_reservedSize=-1;
+         __atomic_store_n( &m_backPos, m_reservedPos + recordSize( size ), __ATOMIC_RELEASE );
+      }
+
+      void commit()
+      {
+         commit( m_reservedSize );
+      }
+
+      /**
+       * @brief  Copy a record into the ring
+       * @return false if there is not enough space
+       */
+      bool push( const void* data, int size )
+      {
+         void* record=reserve( size );
+
+         if( !record )
+         {
+            return( false );
+         }
+         memcpy( record, data, size );
+         commit( size );
+
+         return( true );
+      }
+
+      //--- Consumer side ---------------------------------------------------
+
+      /**
+       * @brief  Oldest record; stays valid until release()
+       * @return Record with its size; data is nullptr if the ring is empty
+       */
+      SRecord peek() const
+      {
+         if( ! isDataAvailable() )
+         {
+            return( SRecord{ nullptr, 0 } );
+         }
+         ringIndex_t pos=skipPadding( m_frontPos );
+
+         return( SRecord{ &m_data[ ( pos + HEADER ) & m_mask ], (int)length( pos ) } );
+      }
+
+      /**
+       * @brief  Drop the oldest record and hand its memory back
+       */
+      void release()
+      {
+         if( ! isDataAvailable() )
+         {
+            lFatal("NE");
+         }
+         ringIndex_t pos=skipPadding( m_frontPos );
+
+         __atomic_store_n( &m_frontPos, pos + recordSize( length( pos ) ), __ATOMIC_RELEASE );
+      }
+
+      /**
+       * @brief  Copy the oldest record out and drop it. Only up to 'maxSize'
+       *         bytes are copied.
+       * @return Size of the record; -1 if the ring is empty
+       */
+      int pop( void* data, int maxSize )
+      {
+         SRecord record=peek();
+
+         if( !record.data )
+         {
+            return( -1 );
+         }
+         memcpy( data, record.data, MIN( record.size, maxSize ) );
+         release();
+
+         return( record.size );
+      }
+};
+
+
+/*--- Fin ------------------------------------------------------------------*/
+#endif // ? ! LEPTO_RECORD_RING_HPP
@@ -28,8 +28,9 @@ class CRing: public CList<T>
 {
    public:
 
-      CRing(int maxEntries = CONFIG_LEPTO_RING_DEFAULT_SIZE)
-         :CList<T>(maxEntries)
+      CRing(int maxEntries = CONFIG_LEPTO_RING_DEFAULT_SIZE,
+            CMemoryResource* resource = nullptr)
+         :CList<T>(maxEntries, resource)
       {
       }
 };
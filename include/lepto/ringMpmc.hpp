@@ -0,0 +1,277 @@
+#ifndef LEPTO_RING_MPMC_HPP
+#define LEPTO_RING_MPMC_HPP
+/**---------------------------------------------------------------------------
+ *
+ * @file    ringMpmc.hpp
+ * @brief   Ring buffer for multiple producers and multiple consumers
+ *
+ * Every slot carries its own sequence stamp (D. Vyukov's bounded MPMC queue).
+ * A producer claims a position by CAS on m_backPos and publishes the slot by
+ * stamping it. A consumer claims a position by CAS on m_frontPos as soon as
+ * that single slot is stamped. Unlike CList there is no global
+ * m_busyProducing counter: a slow producer only blocks its own slot, not the
+ * whole ring.
+ *
+ * Stamp of a slot at position 'pos':
+ *    pos                  free, can be reserved by producer for 'pos'
+ *    pos + 1              published, can be acquired by consumer for 'pos'
+ *    pos + N              released, can be reserved for 'pos + N'
+ *
+ * The capacity has to be a power of two.
+ *
+ * Example:
+ *    CMpmcRing<int> fifo(16);
+ *    ringIndex_t slot=fifo.tryReserve();
+ *    *fifo.reservedEntry(slot)=0x10;
+ *    fifo.pushReserved(slot);
+ *
+ *    slot=fifo.tryAcquire();
+ *    printf( "Entry: 0x%X\n", *fifo.acquiredEntry(slot) ); // 0x10
+ *    fifo.release(slot);
+ *
+ * @date   20261017
+ * @author Maximilian Seesslen <src@seesslen.net>
+ * @copyright SPDX-License-Identifier: Apache-2.0
+ *
+ *--------------------------------------------------------------------------*/
+
+
+/*--- Includes -------------------------------------------------------------*/
+
+
+#include <lepto/list.hpp>     // ringIndex_t, configs
+
+
+/*--- Definitions ----------------------------------------------------------*/
+
+
+template <typename T>
+class CMpmcRing
+{
+   private:
+      struct SSlot
+      {
+         ringIndex_t sequence;
+         T data;
+      };
+
+      SSlot* m_slots;
+      ringIndex_t m_mask;
+      ringIndex_t m_frontPos;
+      ringIndex_t m_backPos;
+
+      static int diff( ringIndex_t a, ringIndex_t b )
+      {
+         return( (int)( a - b ) );
+      }
+
+      /**
+       * @brief Called before the slots are allocated; a negative size would
+       *        already fail in new[]
+       */
+      static int validSize( int maxEntries )
+      {
+         if( ( maxEntries <= 0 ) || ( maxEntries & ( maxEntries - 1 ) ) )
+         {
+            // Not a power of two
+            lFatal( "NP2" );
+         }
+         return( maxEntries );
+      }
+
+   public:
+
+      CMpmcRing( int maxEntries )
+         :m_slots( new SSlot[ validSize( maxEntries ) ] )
+         ,m_mask( maxEntries - 1 )
+         ,m_frontPos(0)
+         ,m_backPos(0)
+      {
+         for( int i1=0; i1<maxEntries; i1++ )
+         {
+            m_slots[i1].sequence=i1;
+         }
+      }
+
+      ~CMpmcRing()
+      {
+         delete[] m_slots;
+         m_slots=nullptr;
+      }
+
+      CMpmcRing( const CMpmcRing& ) = delete;
+      CMpmcRing& operator=( const CMpmcRing& ) = delete;
+
+      int getMaxEntries() const
+      {
+         return( m_mask + 1 );
+      }
+
+      /**
+       * @brief  Get the ammount of reserved and not yet released entries.
+       *         Only a snapshot when other threads are active.
+       */
+      int count() const
+      {
+         int entries=diff( __atomic_load_n( &m_backPos, __ATOMIC_RELAXED ),
+                           __atomic_load_n( &m_frontPos, __ATOMIC_RELAXED ) );
+         return( MAX( 0, MIN( entries, getMaxEntries() ) ) );
+      }
+
+      /**
+       * @brief  Check if the slot at the front is published
+       */
+      bool isDataAvailable() const
+      {
+         ringIndex_t pos=__atomic_load_n( &m_frontPos, __ATOMIC_RELAXED );
+         const SSlot& slot=m_slots[ pos & m_mask ];
+         return( diff( __atomic_load_n( &slot.sequence, __ATOMIC_ACQUIRE ), pos + 1 ) >= 0 );
+      }
+
+      /**
+       * @brief   Reserve an entry that can be pushed later by pushReserved().
+       *          Thread safe for any number of producers.
+       * @return  Slot of the reserved element or '-1' if buffer is full
+       */
+      ringIndex_t tryReserve()
+      {
+         ringIndex_t pos=__atomic_load_n( &m_backPos, __ATOMIC_RELAXED );
+
+         while( true )
+         {
+            SSlot& slot=m_slots[ pos & m_mask ];
+            int dif=diff( __atomic_load_n( &slot.sequence, __ATOMIC_ACQUIRE ), pos );
+
+            if( dif == 0 )
+            {
+               if( __atomic_compare_exchange_n( &m_backPos, &pos, pos + 1,
+                     true, __ATOMIC_RELAXED, __ATOMIC_RELAXED ) )
+               {
+                  return( pos & m_mask );
+               }
+               // 'pos' got updated by the failing CAS
+            }
+            else if( dif < 0 )
+            {
+               // Slot still holds the entry of the previous lap
+               return( -1 );
+            }
+            else
+            {
+               pos=__atomic_load_n( &m_backPos, __ATOMIC_RELAXED );
+            }
+         }
+      }
+
+      T* reservedEntry( ringIndex_t index ) const
+      {
+         if( index == (ringIndex_t)-1 )
+         {
+            return( nullptr );
+         }
+         return( &m_slots[ index ].data );
+      }
+
+      /**
+       * @brief   Publish an previously reserved entry
+       */
+      void pushReserved( ringIndex_t index )
+      {
+         SSlot& slot=m_slots[ index ];
+         // Nobody else touches the stamp while reserved; it is still 'pos'
+         __atomic_store_n( &slot.sequence, slot.sequence + 1, __ATOMIC_RELEASE );
+      }
+
+      /**
+       * @brief   Acquire the entry at the front. Thread safe for any number
+       *          of consumers. Entries are acquired in FIFO order.
+       * @return  Slot of the acquired element or '-1' if no entry is
+       *          published at the front
+       */
+      ringIndex_t tryAcquire()
+      {
+         ringIndex_t pos=__atomic_load_n( &m_frontPos, __ATOMIC_RELAXED );
+
+         while( true )
+         {
+            SSlot& slot=m_slots[ pos & m_mask ];
+            int dif=diff( __atomic_load_n( &slot.sequence, __ATOMIC_ACQUIRE ), pos + 1 );
+
+            if( dif == 0 )
+            {
+               if( __atomic_compare_exchange_n( &m_frontPos, &pos, pos + 1,
+                     true, __ATOMIC_RELAXED, __ATOMIC_RELAXED ) )
+               {
+                  return( pos & m_mask );
+               }
+            }
+            else if( dif < 0 )
+            {
+               // Empty, or the producer of this slot is not done yet
+               return( -1 );
+            }
+            else
+            {
+               pos=__atomic_load_n( &m_frontPos, __ATOMIC_RELAXED );
+            }
+         }
+      }
+
+      T* acquiredEntry( ringIndex_t index ) const
+      {
+         if( index == (ringIndex_t)-1 )
+         {
+            return( nullptr );
+         }
+         return( &m_slots[ index ].data );
+      }
+
+      /**
+       * @brief   Release an previously acquired entry for the producers
+       */
+      void release( ringIndex_t index )
+      {
+         SSlot& slot=m_slots[ index ];
+         // Stamp is 'pos + 1'; free it for 'pos + N'
+         __atomic_store_n( &slot.sequence, slot.sequence + m_mask, __ATOMIC_RELEASE );
+      }
+
+      bool push_back( const T value )
+      {
+         ringIndex_t index=tryReserve();
+
+         if( index == (ringIndex_t)-1 )
+         {
+            #if IS_ENABLED( CONFIG_LEPTO_LIST_ABORT_FAILING_PUSH )
+               abort();
+            #endif
+            return( false );
+         }
+         m_slots[ index ].data=value;
+         pushReserved( index );
+
+         return( true );
+      }
+
+      /**
+       * @brief   Pop the front entry into 'value'
+       * @return  false if no entry was available
+       */
+      bool pop( T& value )
+      {
+         ringIndex_t index=tryAcquire();
+
+         if( index == (ringIndex_t)-1 )
+         {
+            return( false );
+         }
+         value=m_slots[ index ].data;
+         release( index );
+
+         return( true );
+      }
+};
+
+
+/*--- Fin ------------------------------------------------------------------*/
+#endif // ? ! LEPTO_RING_MPMC_HPP
@@ -0,0 +1,52 @@
+#ifndef LEPTO_RING_POW2_HPP
+#define LEPTO_RING_POW2_HPP
+/**---------------------------------------------------------------------------
+ *
+ * @file    ringPow2.hpp
+ * @brief   Ring buffer with compile time capacity of power of two
+ *
+ * CStaticRing<T, N> restricted to a power of two capacity. All index
+ * arithmetic is done by masking instead of modulo. On an cortex-m0 there is
+ * no division instruction at all, on bigger cores the division is still the
+ * most expensive part of every push and pop.
+ *
+ * The index pointers are free running. They simply overflow at the range of
+ * ringIndex_t. Because the capacity is a divisor of that range, the slot
+ * stays consistent over the overflow and "back - front" is always the number
+ * of entries. There is no need for the DUPLICATE_FACTOR of CList.
+ *
+ * The slots are part of the object like for CStaticRing. Allocate big rings
+ * by new or place them statically.
+ *
+ * Example:
+ *    CRingPow2<int, 16> fifo;
+ *    fifo.push_back(0x10);
+ *    printf( "Entry: 0x%X\n", fifo.pop() ); // 0x10
+ *
+ * There must be only exist one consumer but multiple producers may exist.
+ *
+ * @date   20261017
+ * @author Maximilian Seesslen <src@seesslen.net>
+ * @copyright SPDX-License-Identifier: Apache-2.0
+ *
+ *--------------------------------------------------------------------------*/
+
+
+/*--- Includes -------------------------------------------------------------*/
+
+
+#include <lepto/staticRing.hpp>
+
+
+/*--- Definitions ----------------------------------------------------------*/
+
+
+template <typename T, ringIndex_t N>
+class CRingPow2: public CStaticRing<T, N>
+{
+   static_assert( N && ( ( N & ( N - 1 ) ) == 0 ), "Capacity has to be a power of two" );
+};
+
+
+/*--- Fin ------------------------------------------------------------------*/
+#endif // ? ! LEPTO_RING_POW2_HPP
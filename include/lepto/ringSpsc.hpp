@@ -0,0 +1,338 @@
+#ifndef LEPTO_RING_SPSC_HPP
+#define LEPTO_RING_SPSC_HPP
+/**---------------------------------------------------------------------------
+ *
+ * @file    ringSpsc.hpp
+ * @brief   Wait-free ring buffer for one producer and one consumer
+ *
+ * Only one thread pushes and only one thread pops. Each index is written by
+ * exactly one side, so no CAS and no m_busyProducing counter is needed. A
+ * push is a plain store into the slot followed by a release store of the
+ * back index. A pop is an acquire load of the back index, the read of the
+ * slot and a release store of the front index. On x86 this compiles to
+ * ordinary moves; there are no locked instructions.
+ *
+ * The indices run in the range [0, 2*N) and are wrapped by compare and
+ * subtract, so there is no division either.
+ *
+ * Example:
+ *    CSpscRing<int> fifo(10);
+ *    fifo.push_back(0x10);                     // Producer thread / ISR
+ *    printf( "Entry: 0x%X\n", fifo.pop() );    // Consumer thread
+ *
+ * @date   20261017
+ * @author Maximilian Seesslen <src@seesslen.net>
+ * @copyright SPDX-License-Identifier: Apache-2.0
+ *
+ *--------------------------------------------------------------------------*/
+
+
+/*--- Includes -------------------------------------------------------------*/
+
+
+#include <lepto/list.hpp>     // ringIndex_t, configs, CMemoryResource
+
+
+/*--- Definitions ----------------------------------------------------------*/
+
+
+template <typename T>
+class CSpscRing
+{
+   private:
+      T* m_buffers;
+      CMemoryResource* m_resource;
+      ringIndex_t m_maxEntries;
+      ringIndex_t m_frontPos;       // Written by consumer only
+      ringIndex_t m_backPos;        // Written by producer only
+
+      ringIndex_t next( ringIndex_t pos ) const
+      {
+         pos++;
+         if( pos == 2 * m_maxEntries )
+         {
+            pos=0;
+         }
+         return( pos );
+      }
+
+      ringIndex_t slot( ringIndex_t pos ) const
+      {
+         return( ( pos >= m_maxEntries ) ? ( pos - m_maxEntries ) : pos );
+      }
+
+      // 'entries' may be up to m_maxEntries
+      ringIndex_t advance( ringIndex_t pos, int entries ) const
+      {
+         pos+=entries;
+         if( pos >= 2 * m_maxEntries )
+         {
+            pos-=2 * m_maxEntries;
+         }
+         return( pos );
+      }
+
+      int used( ringIndex_t front, ringIndex_t back ) const
+      {
+         if( back >= front )
+         {
+            return( (int)( back - front ) );
+         }
+         return( (int)( back + 2 * m_maxEntries - front ) );
+      }
+
+      ringIndex_t loadFront() const
+      {
+         return( __atomic_load_n( &m_frontPos, __ATOMIC_ACQUIRE ) );
+      }
+
+      ringIndex_t loadBack() const
+      {
+         return( __atomic_load_n( &m_backPos, __ATOMIC_ACQUIRE ) );
+      }
+
+   public:
+
+      /**
+       * @param resource: Where to take the storage from; nullptr for
+       *        global new/delete
+       */
+      CSpscRing( int maxEntries, CMemoryResource* resource = nullptr )
+         :m_resource( resource )
+         ,m_maxEntries( maxEntries )
+         ,m_frontPos(0)
+         ,m_backPos(0)
+      {
+         lAssert( maxEntries > 0 );
+         if( m_resource )
+         {
+            m_buffers=(T*)m_resource->allocate( maxEntries * sizeof( T ), alignof( T ) );
+            lFullAssert( m_buffers != nullptr );
+            for( int i1=0; i1<maxEntries; i1++ )
+            {
+               new( &m_buffers[i1] ) T();
+            }
+         }
+         else
+         {
+            m_buffers=new T[ maxEntries ];
+         }
+      }
+
+      ~CSpscRing()
+      {
+         if( m_resource )
+         {
+            for( ringIndex_t i1=0; i1<m_maxEntries; i1++ )
+            {
+               m_buffers[i1].~T();
+            }
+            m_resource->deallocate( m_buffers, m_maxEntries * sizeof( T ), alignof( T ) );
+         }
+         else
+         {
+            delete[] m_buffers;
+         }
+         m_buffers=nullptr;
+      }
+
+      CSpscRing( const CSpscRing& ) = delete;
+      CSpscRing& operator=( const CSpscRing& ) = delete;
+
+      /**
+       * @brief  Reset the ring. Neither producer nor consumer may be active.
+       */
+      void clear()
+      {
+         m_frontPos=m_backPos=0;
+      }
+
+      int getMaxEntries() const
+      {
+         return( m_maxEntries );
+      }
+
+      /**
+       * @brief  Get the ammount of pushed/poppabel entries
+       */
+      int count() const
+      {
+         return( used( loadFront(), loadBack() ) );
+      }
+
+      int getFreeCount() const
+      {
+         return( getMaxEntries() - count() );
+      }
+
+      bool isFull() const
+      {
+         return( count() == (int)m_maxEntries );
+      }
+
+      bool pushable() const
+      {
+         return( ! isFull() );
+      }
+
+      bool isDataAvailable() const
+      {
+         return( loadBack() != m_frontPos );
+      }
+
+      //--- Producer side ---------------------------------------------------
+
+      /**
+       * @brief Get pointer to the entry at top position.
+       *        This can be used before pushBack() is called.
+       *
+       * @return Pointer to top entry or nullptr if the buffer is full
+       */
+      T *backEntry() const
+      {
+         if( used( loadFront(), m_backPos ) == (int)m_maxEntries )
+         {
+            return( nullptr );
+         }
+         return( &m_buffers[ slot( m_backPos ) ] );
+      }
+
+      /**
+       * @brief  Publish the entry on the top index
+       */
+      void pushBack()
+      {
+         lAssert( pushable() );
+         __atomic_store_n( &m_backPos, next( m_backPos ), __ATOMIC_RELEASE );
+      }
+
+      /**
+       * @brief  Get pointer to the free entry 'index' positions after the
+       *         top one, to fill several entries before pushBack( entries ).
+       * @return nullptr if there are not that many free entries
+       */
+      T *getBackEntry( int index ) const
+      {
+         if( index >= (int)m_maxEntries - used( loadFront(), m_backPos ) )
+         {
+            return( nullptr );
+         }
+         return( &m_buffers[ slot( advance( m_backPos, index ) ) ] );
+      }
+
+      /**
+       * @brief  Publish 'entries' entries at once
+       */
+      void pushBack( int entries )
+      {
+         lAssert( ( entries >= 0 ) && ( entries <= getFreeCount() ) );
+         __atomic_store_n( &m_backPos, advance( m_backPos, entries ), __ATOMIC_RELEASE );
+      }
+
+      bool push_back( const T value )
+      {
+         T* entry=backEntry();
+
+         if( ! entry )
+         {
+            #if IS_ENABLED( CONFIG_LEPTO_LIST_ABORT_FAILING_PUSH )
+               abort();
+            #endif
+            return( false );
+         }
+         *entry=value;
+         __atomic_store_n( &m_backPos, next( m_backPos ), __ATOMIC_RELEASE );
+
+         return( true );
+      }
+
+      CSpscRing& operator << ( const T value )
+      {
+         push_back( value );
+         return( *this );
+      }
+
+      //--- Consumer side ---------------------------------------------------
+
+      /**
+       * @brief Get pointer to the entry at bottom position.
+       * @return Pointer to bottom entry or nullptr if no entries are available
+       */
+      T *frontEntry() const
+      {
+         if( ! isDataAvailable() )
+         {
+            return( nullptr );
+         }
+         return( &m_buffers[ slot( m_frontPos ) ] );
+      }
+
+      /**
+       * @brief Drop the entry at bottom position.
+       */
+      void dropFront()
+      {
+         if( ! isDataAvailable() )
+         {
+            lFatal("NE");
+         }
+         __atomic_store_n( &m_frontPos, next( m_frontPos ), __ATOMIC_RELEASE );
+      }
+
+      /**
+       * @brief  Get pointer to the entry 'index' positions after the bottom
+       *         one.
+       * @return nullptr if there are not that many entries
+       */
+      T *getFrontEntry( int index ) const
+      {
+         if( index >= used( m_frontPos, loadBack() ) )
+         {
+            return( nullptr );
+         }
+         return( &m_buffers[ slot( advance( m_frontPos, index ) ) ] );
+      }
+
+      /**
+       * @brief  Drop 'entries' entries at once
+       */
+      void dropFront( int entries )
+      {
+         if( ( entries < 0 ) || ( entries > used( m_frontPos, loadBack() ) ) )
+         {
+            lFatal("NE");
+         }
+         __atomic_store_n( &m_frontPos, advance( m_frontPos, entries ), __ATOMIC_RELEASE );
+      }
+
+      T pop()
+      {
+         T value{0};
+
+         if( isDataAvailable() )
+         {
+            value=m_buffers[ slot( m_frontPos ) ];
+            __atomic_store_n( &m_frontPos, next( m_frontPos ), __ATOMIC_RELEASE );
+         }
+
+         return( value );
+      }
+
+   protected:
+
+      /**
+       * @brief Direct reference to entry
+       *        This is only used in inherited classes.
+       * @param pos: Real index to entry
+       * @return reference
+       */
+      T &rawEntry( ringIndex_t pos ) const
+      {
+         lAssert( pos < m_maxEntries );
+         return( m_buffers[ pos ] );
+      }
+};
+
+
+/*--- Fin ------------------------------------------------------------------*/
+#endif // ? ! LEPTO_RING_SPSC_HPP
@@ -0,0 +1,403 @@
+#ifndef LEPTO_SEGMENTED_RING_HPP
+#define LEPTO_SEGMENTED_RING_HPP
+/**---------------------------------------------------------------------------
+ *
+ * @file    segmentedRing.hpp
+ * @brief   Unbounded FIFO for multiple producers and one consumer
+ *
+ * The queue is a linked chain of fixed size segments. Producers claim a slot
+ * in the tail segment with a single atomic increment. When the tail segment
+ * is used up, the next segment is appended to the chain. Existing entries
+ * are never moved, so producers never see a buffer being exchanged like in
+ * CList::expand().
+ *
+ *    m_head                            m_tail
+ *      |                                 |
+ *    [****] -> [****] -> [****] -> [**  ]
+ *     \-- m_headPos
+ *
+ * Segments which are consumed completely are not freed but recycled via a
+ * free list. In steady state there is no malloc at all. The consumer only
+ * hands segments over to the free list while no producer is active
+ * (m_busyProducing is 0, checked after the spares have been taken). So a
+ * producer never touches a recycled segment and the free list can not suffer
+ * from the ABA problem. The segment m_tail points to is never retired, even
+ * when it is consumed completely.
+ *
+ * A producer that loses the race for linking the next segment puts its
+ * segment to m_spare. Producers only push to that list; the consumer moves
+ * it to the free list while recycling.
+ *
+ * Example:
+ *    CSegmentedRing<int> fifo;
+ *    fifo.push_back(0x10);                  // Any thread
+ *    int value;
+ *    if( fifo.pop( value ) )                // Consumer thread
+ *       printf( "Entry: 0x%X\n", value ); // 0x10
+ *
+ * @date   20261017
+ * @author Maximilian Seesslen <src@seesslen.net>
+ * @copyright SPDX-License-Identifier: Apache-2.0
+ *
+ *--------------------------------------------------------------------------*/
+
+
+/*--- Includes -------------------------------------------------------------*/
+
+
+#include <lepto/list.hpp>     // configs
+
+
+/*--- Definitions ----------------------------------------------------------*/
+
+
+template <typename T, int SEGMENT_ENTRIES = 32>
+class CSegmentedRing
+{
+   static_assert( SEGMENT_ENTRIES > 0, "Segments must not be empty" );
+
+   private:
+      struct SSegment
+      {
+         SSegment* next;                     // Chain; fixed until recycled
+         SSegment* recycled;                 // Retired or free list
+         int reserved;                       // Claimed slots; may exceed SEGMENT_ENTRIES
+         char ready[ SEGMENT_ENTRIES ];      // Slot is published
+         T entries[ SEGMENT_ENTRIES ];
+      };
+
+      // Consumer side
+      SSegment* m_head;
+      int m_headPos;
+      SSegment* m_retired;
+
+      // Producer side
+      SSegment* m_tail;
+      int m_busyProducing;
+
+      SSegment* m_free;
+      SSegment* m_spare;
+      int m_allocatedSegments;
+
+      static void reset( SSegment* segment )
+      {
+         segment->next=nullptr;
+         segment->recycled=nullptr;
+         segment->reserved=0;
+         memset( segment->ready, 0, sizeof( segment->ready ) );
+      }
+
+      SSegment* allocateSegment()
+      {
+         SSegment* segment=new SSegment;
+         lFullAssert( segment != nullptr );
+         reset( segment );
+         __atomic_add_fetch( &m_allocatedSegments, 1, __ATOMIC_RELAXED );
+         return( segment );
+      }
+
+      /**
+       * @brief Take a segment from the free list or allocate a new one.
+       *        Called by producers only.
+       */
+      SSegment* obtainSegment()
+      {
+         SSegment* segment=__atomic_load_n( &m_free, __ATOMIC_ACQUIRE );
+
+         while( segment )
+         {
+            SSegment* next=__atomic_load_n( &segment->recycled, __ATOMIC_RELAXED );
+            if( __atomic_compare_exchange_n( &m_free, &segment, next, true,
+                                             __ATOMIC_ACQUIRE, __ATOMIC_ACQUIRE ) )
+            {
+               return( segment );
+            }
+         }
+
+         return( allocateSegment() );
+      }
+
+      /**
+       * @brief Push 'segment' to the list 'list' links by 'recycled'
+       */
+      static void pushRecycled( SSegment** list, SSegment* segment )
+      {
+         SSegment* head=__atomic_load_n( list, __ATOMIC_RELAXED );
+         do
+         {
+            __atomic_store_n( &segment->recycled, head, __ATOMIC_RELAXED );
+         }while( ! __atomic_compare_exchange_n( list, &head, segment, true,
+                                                __ATOMIC_RELEASE, __ATOMIC_RELAXED ) );
+      }
+
+      /**
+       * @brief Hand retired and spare segments to the free list. Consumer
+       *        only.
+       */
+      void recycle()
+      {
+         if( ! m_retired && ! __atomic_load_n( &m_spare, __ATOMIC_RELAXED ) )
+         {
+            return;
+         }
+
+         recycleSegments( takeSpares() );
+      }
+
+   protected:
+
+      /**
+       * @brief Take the whole spare list. Consumer only; protected for tests.
+       */
+      SSegment* takeSpares()
+      {
+         // Not reordered with the check of m_busyProducing behind
+         return( __atomic_exchange_n( &m_spare, nullptr, __ATOMIC_SEQ_CST ) );
+      }
+
+      /**
+       * @brief Move the retired segments and the spares taken before to the
+       *        free list. A producer that got busy meanwhile may already
+       *        hold one of the spares as free list head; then they go back
+       *        to m_spare. Consumer only; protected for tests.
+       */
+      void recycleSegments( SSegment* spare )
+      {
+         if( __atomic_load_n( &m_busyProducing, __ATOMIC_SEQ_CST ) )
+         {
+            while( spare )
+            {
+               SSegment* segment=spare;
+               spare=spare->recycled;
+               pushRecycled( &m_spare, segment );
+            }
+            return;
+         }
+
+         while( m_retired )
+         {
+            SSegment* segment=m_retired;
+            m_retired=m_retired->recycled;
+            reset( segment );
+            pushRecycled( &m_free, segment );
+         }
+
+         while( spare )
+         {
+            SSegment* segment=spare;
+            spare=spare->recycled;
+            reset( segment );
+            pushRecycled( &m_free, segment );
+         }
+      }
+
+      void enterProducer()
+      {
+         __atomic_add_fetch( &m_busyProducing, 1, __ATOMIC_SEQ_CST );
+      }
+
+      void leaveProducer()
+      {
+         __atomic_sub_fetch( &m_busyProducing, 1, __ATOMIC_SEQ_CST );
+      }
+
+      /**
+       * @brief  Link 'segment' behind the used up segment 'tail'. If
+       *         another producer was faster, 'segment' goes to the spare
+       *         list. Producers only; protected for tests.
+       * @return The segment behind 'tail'
+       */
+      SSegment* linkSegment( SSegment* tail, SSegment* segment )
+      {
+         SSegment* next=nullptr;
+
+         if( __atomic_compare_exchange_n( &tail->next, &next, segment, false,
+                                          __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE ) )
+         {
+            return( segment );
+         }
+         pushRecycled( &m_spare, segment );
+
+         return( next );
+      }
+
+      SSegment* getTail() const
+      {
+         return( __atomic_load_n( &m_tail, __ATOMIC_ACQUIRE ) );
+      }
+
+      SSegment* takeSegment()
+      {
+         return( obtainSegment() );
+      }
+
+   private:
+
+      static void deleteChain( SSegment* segment, bool recycled )
+      {
+         while( segment )
+         {
+            SSegment* next=recycled ? segment->recycled : segment->next;
+            delete( segment );
+            segment=next;
+         }
+      }
+
+   public:
+
+      /**
+       * @param spareSegments: Segments to allocate up front in addition to
+       *        the first one.
+       */
+      CSegmentedRing( int spareSegments = 0 )
+         :m_headPos(0)
+         ,m_retired(nullptr)
+         ,m_busyProducing(0)
+         ,m_free(nullptr)
+         ,m_spare(nullptr)
+         ,m_allocatedSegments(0)
+      {
+         m_head=m_tail=allocateSegment();
+         for( int i1=0; i1<spareSegments; i1++ )
+         {
+            SSegment* segment=allocateSegment();
+            segment->recycled=m_free;
+            m_free=segment;
+         }
+      }
+
+      ~CSegmentedRing()
+      {
+         deleteChain( m_head, false );
+         deleteChain( m_retired, true );
+         deleteChain( m_free, true );
+         deleteChain( m_spare, true );
+      }
+
+      CSegmentedRing( const CSegmentedRing& ) = delete;
+      CSegmentedRing& operator=( const CSegmentedRing& ) = delete;
+
+      static constexpr int getSegmentEntries()
+      {
+         return( SEGMENT_ENTRIES );
+      }
+
+      /**
+       * @brief Number of segments ever allocated. Stays constant in steady
+       *        state.
+       */
+      int getAllocatedSegments() const
+      {
+         return( __atomic_load_n( &m_allocatedSegments, __ATOMIC_RELAXED ) );
+      }
+
+      //--- Producer side ---------------------------------------------------
+
+      /**
+       * @brief Push an entry to the back. Thread safe for any number of
+       *        producers. Never blocks.
+       */
+      bool push_back( const T value )
+      {
+         enterProducer();
+
+         while( true )
+         {
+            SSegment* tail=__atomic_load_n( &m_tail, __ATOMIC_ACQUIRE );
+            int index=__atomic_fetch_add( &tail->reserved, 1, __ATOMIC_ACQ_REL );
+
+            if( index < SEGMENT_ENTRIES )
+            {
+               tail->entries[ index ]=value;
+               __atomic_store_n( &tail->ready[ index ], 1, __ATOMIC_RELEASE );
+               break;
+            }
+
+            // Segment is used up; make sure there is a next one
+            SSegment* next=__atomic_load_n( &tail->next, __ATOMIC_ACQUIRE );
+            if( ! next )
+            {
+               next=linkSegment( tail, obtainSegment() );
+            }
+            __atomic_compare_exchange_n( &m_tail, &tail, next, false,
+                                         __ATOMIC_RELEASE, __ATOMIC_RELAXED );
+         }
+
+         leaveProducer();
+
+         return( true );
+      }
+
+      CSegmentedRing& operator << ( const T value )
+      {
+         push_back( value );
+         return( *this );
+      }
+
+      //--- Consumer side ---------------------------------------------------
+
+      /**
+       * @brief Get pointer to the front entry
+       * @return Pointer to front entry or nullptr if it is not published yet
+       */
+      T* frontEntry()
+      {
+         if( m_headPos == SEGMENT_ENTRIES )
+         {
+            SSegment* next=__atomic_load_n( &m_head->next, __ATOMIC_ACQUIRE );
+            if( ! next || ( m_head == __atomic_load_n( &m_tail, __ATOMIC_ACQUIRE ) ) )
+            {
+               // Producers still push to the tail until they moved on
+               return( nullptr );
+            }
+            // A late producer may still read m_head->next; leave it alone
+            m_head->recycled=m_retired;
+            m_retired=m_head;
+            m_head=next;
+            m_headPos=0;
+         }
+         recycle();
+
+         if( ! __atomic_load_n( &m_head->ready[ m_headPos ], __ATOMIC_ACQUIRE ) )
+         {
+            return( nullptr );
+         }
+         return( &m_head->entries[ m_headPos ] );
+      }
+
+      bool isDataAvailable()
+      {
+         return( frontEntry() != nullptr );
+      }
+
+      /**
+       * @brief Drop the front entry. frontEntry() must have returned it.
+       */
+      void dropFront()
+      {
+         lAssert( m_headPos < SEGMENT_ENTRIES );
+         m_headPos++;
+      }
+
+      /**
+       * @brief Pop the front entry into 'value'
+       * @return false if no entry was available
+       */
+      bool pop( T& value )
+      {
+         T* entry=frontEntry();
+
+         if( ! entry )
+         {
+            return( false );
+         }
+         value=*entry;
+         dropFront();
+
+         return( true );
+      }
+};
+
+
+/*--- Fin ------------------------------------------------------------------*/
+#endif // ? ! LEPTO_SEGMENTED_RING_HPP
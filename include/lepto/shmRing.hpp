@@ -0,0 +1,329 @@
+#ifndef LEPTO_SHM_RING_HPP
+#define LEPTO_SHM_RING_HPP
+/**---------------------------------------------------------------------------
+ *
+ * @file    shmRing.hpp
+ * @brief   Ring buffer in shared memory for exchanging entries between
+ *          processes
+ *
+ * Header (capacity and indices) and entries live in one shared mapping.
+ * Nothing in the mapping is a pointer, so every process may map it at
+ * another address. The protocol is the one of CList: producers reserve an
+ * entry by CAS on the back index, write it and publish it via
+ * pushReserved(); the consumer sees new entries only while no producer is
+ * busy. Any number of producer processes/threads but only one consumer.
+ *
+ * The mapping is either a named POSIX shared memory object (create()/
+ * attach() by name) or an anonymous memfd (create( nullptr, ... )) which is
+ * inherited by fork() or handed over via its file descriptor.
+ *
+ * Entries have to be trivially copyable; they must not contain pointers
+ * into the address space of one process.
+ *
+ * A producer dying between tryReserve() and pushReserved() blocks the
+ * consumer for ever.
+ *
+ * Example:
+ *    CShmRing<SElement> fifo;
+ *    fifo.create( "/elements", 1024 );           // Process A
+ *    fifo.push_back( element );
+ *
+ *    CShmRing<SElement> fifo;
+ *    fifo.attach( "/elements" );                 // Process B
+ *    SElement element;
+ *    fifo.pop( element );
+ *
+ * @date   20261017
+ * @author Maximilian Seesslen <src@seesslen.net>
+ * @copyright SPDX-License-Identifier: Apache-2.0
+ *
+ *--------------------------------------------------------------------------*/
+
+
+/*--- Includes -------------------------------------------------------------*/
+
+
+#include <lepto/list.hpp>     // ringIndex_t, configs
+
+#if defined( __linux__ )
+
+#include <stdint.h>
+
+
+/*--- Definitions ----------------------------------------------------------*/
+
+
+/**
+ * @brief Shared mapping with a small header; the untyped part of CShmRing
+ */
+class CShmMapping
+{
+   public:
+      struct SHeader
+      {
+         uint32_t magic;
+         uint32_t entrySize;
+         ringIndex_t maxEntries;
+         ringIndex_t wrap;                // Indices run in [0, wrap)
+         // Same layout for every build config of the attaching processes
+         alignas( CONFIG_LEPTO_CACHELINE_SIZE ) ringIndex_t frontPos;
+         alignas( CONFIG_LEPTO_CACHELINE_SIZE ) ringIndex_t backPos;
+         int busyProducing;
+      };
+
+      static constexpr uint32_t MAGIC = 0x4C52494E;    // "LRIN"
+
+   private:
+      SHeader* m_header;
+      size_t m_size;
+      int m_fd;
+      int m_ownerPid;                     // Unlinks a named object
+      char m_name[ 64 ];
+
+      bool map( int fd, size_t size );
+
+   protected:
+      static size_t headerSize()
+      {
+         return( ( sizeof( SHeader ) + CONFIG_LEPTO_CACHELINE_SIZE - 1 )
+                 & ~(size_t)( CONFIG_LEPTO_CACHELINE_SIZE - 1 ) );
+      }
+
+      SHeader* header() const
+      {
+         return( m_header );
+      }
+
+      void* entries() const
+      {
+         return( (char*)m_header + headerSize() );
+      }
+
+      bool create( const char* name, uint32_t entrySize, int maxEntries );
+      bool attach( const char* name, uint32_t entrySize );
+      bool attachFd( int fd, uint32_t entrySize );
+
+   public:
+      CShmMapping();
+      ~CShmMapping();
+
+      CShmMapping( const CShmMapping& ) = delete;
+      CShmMapping& operator=( const CShmMapping& ) = delete;
+
+      /**
+       * @brief Unmap. The creating process also unlinks a named object (not
+       *        its forked children); attached processes keep their mapping.
+       */
+      void detach();
+
+      bool isAttached() const
+      {
+         return( m_header != nullptr );
+      }
+
+      /**
+       * @brief File descriptor of the mapping; can be passed to other
+       *        processes for attachFd()
+       */
+      int getFd() const
+      {
+         return( m_fd );
+      }
+
+      static bool unlink( const char* name );
+};
+
+
+template <typename T>
+class CShmRing: public CShmMapping
+{
+   static_assert( __is_trivially_copyable( T ), "Entries are copied between processes" );
+
+   private:
+      T* m_entries=nullptr;
+
+      ringIndex_t next( ringIndex_t pos, int n = 1 ) const
+      {
+         pos+=n;
+         if( pos >= header()->wrap )
+         {
+            pos-=header()->wrap;
+         }
+         return( pos );
+      }
+
+      int used( ringIndex_t front, ringIndex_t back ) const
+      {
+         if( back >= front )
+         {
+            return( (int)( back - front ) );
+         }
+         return( (int)( back + header()->wrap - front ) );
+      }
+
+   public:
+
+      /**
+       * @brief Create a new ring
+       * @param name: Name of the POSIX shared memory object, e.g. "/log"
+       *        or nullptr for an anonymous memfd
+       * @return false if the object exists already or on error
+       */
+      bool create( const char* name, int maxEntries )
+      {
+         bool created=CShmMapping::create( name, sizeof( T ), maxEntries );
+         m_entries=created ? (T*)entries() : nullptr;
+         return( created );
+      }
+
+      /**
+       * @brief Attach to a ring created by another process
+       * @return false if it does not exist or was created for another type
+       */
+      bool attach( const char* name )
+      {
+         bool attached=CShmMapping::attach( name, sizeof( T ) );
+         m_entries=attached ? (T*)entries() : nullptr;
+         return( attached );
+      }
+
+      /**
+       * @brief Attach via a file descriptor, e.g. received over a unix
+       *        socket. The ring owns and closes 'fd' on success.
+       */
+      bool attachFd( int fd )
+      {
+         bool attached=CShmMapping::attachFd( fd, sizeof( T ) );
+         m_entries=attached ? (T*)entries() : nullptr;
+         return( attached );
+      }
+
+      int getMaxEntries() const
+      {
+         return( header()->maxEntries );
+      }
+
+      int count() const
+      {
+         return( used( __atomic_load_n( &header()->frontPos, __ATOMIC_ACQUIRE ),
+                       __atomic_load_n( &header()->backPos, __ATOMIC_ACQUIRE ) ) );
+      }
+
+      bool isFull() const
+      {
+         return( count() == getMaxEntries() );
+      }
+
+      /**
+       * @brief  Entries are available and no producer is busy
+       */
+      bool isDataAvailable() const
+      {
+         // Back first: a producer that moved it is counted as busy until
+         // its entry is written
+         ringIndex_t back=__atomic_load_n( &header()->backPos, __ATOMIC_SEQ_CST );
+         return( ( back != header()->frontPos )
+                 && ( __atomic_load_n( &header()->busyProducing, __ATOMIC_SEQ_CST ) == 0 ) );
+      }
+
+      //--- Producer side ---------------------------------------------------
+
+      /**
+       * @brief   Reserve an entry that can be pushed later by pushReserved().
+       *          Thread and process safe for any number of producers.
+       * @return  Index of the reserved element or '-1' if the ring is full
+       */
+      ringIndex_t tryReserve()
+      {
+         SHeader* h=header();
+         ringIndex_t reserved;
+
+         __atomic_add_fetch( &h->busyProducing, 1, __ATOMIC_SEQ_CST );
+         reserved=__atomic_load_n( &h->backPos, __ATOMIC_SEQ_CST );
+         do
+         {
+            if( used( __atomic_load_n( &h->frontPos, __ATOMIC_SEQ_CST ), reserved )
+                == (int)h->maxEntries )
+            {
+               __atomic_sub_fetch( &h->busyProducing, 1, __ATOMIC_SEQ_CST );
+               return( (ringIndex_t)-1 );
+            }
+         }while( ! __atomic_compare_exchange_n( &h->backPos, &reserved, next( reserved ),
+                                                true, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST ) );
+
+         return( reserved );
+      }
+
+      T* reservedEntry( ringIndex_t index ) const
+      {
+         if( index == (ringIndex_t)-1 )
+         {
+            return( nullptr );
+         }
+         return( &m_entries[ index % header()->maxEntries ] );
+      }
+
+      void pushReserved( ringIndex_t index )
+      {
+         (void)index;
+         __atomic_sub_fetch( &header()->busyProducing, 1, __ATOMIC_SEQ_CST );
+      }
+
+      bool push_back( const T& value )
+      {
+         ringIndex_t index=tryReserve();
+
+         if( index == (ringIndex_t)-1 )
+         {
+            return( false );
+         }
+         *reservedEntry( index )=value;
+         pushReserved( index );
+
+         return( true );
+      }
+
+      //--- Consumer side ---------------------------------------------------
+
+      T* frontEntry() const
+      {
+         if( ! isDataAvailable() )
+         {
+            return( nullptr );
+         }
+         return( &m_entries[ header()->frontPos % header()->maxEntries ] );
+      }
+
+      /**
+       * @brief  Drop the entry frontEntry() returned. Producers may be busy
+       *         with other entries meanwhile.
+       */
+      void dropFront()
+      {
+         if( __atomic_load_n( &header()->backPos, __ATOMIC_SEQ_CST ) == header()->frontPos )
+         {
+            lFatal("NE");
+         }
+         __atomic_store_n( &header()->frontPos, next( header()->frontPos ), __ATOMIC_SEQ_CST );
+      }
+
+      bool pop( T& value )
+      {
+         T* entry=frontEntry();
+
+         if( ! entry )
+         {
+            return( false );
+         }
+         value=*entry;
+         dropFront();
+
+         return( true );
+      }
+};
+
+#endif // ? __linux__
+
+
+/*--- Fin ------------------------------------------------------------------*/
+#endif // ? ! LEPTO_SHM_RING_HPP
@@ -0,0 +1,353 @@
+#ifndef LEPTO_STATIC_RING_HPP
+#define LEPTO_STATIC_RING_HPP
+/**---------------------------------------------------------------------------
+ *
+ * @file    staticRing.hpp
+ * @brief   Ring buffer with statically sized, in-object storage
+ *
+ * Same protocol as CList/CRing (tryReserve/pushReserved, frontEntry/dropFront)
+ * but the slots are part of the object itself. There is no allocation and no
+ * pointer indirection. The constructor is constexpr, so a global instance
+ * ends up in .bss and costs nothing at startup.
+ *
+ * When N is a power of two, the indices are free running and masked; see
+ * CRingPow2. Otherwise they run in the range [0, 2*N) and are wrapped by an
+ * compare and subtract. No modulo is used in both cases.
+ *
+ * Example:
+ *    static CStaticRing<int, 24> fifo;
+ *    fifo.push_back(0x10);
+ *    printf( "Entry: 0x%X\n", fifo.pop() ); // 0x10
+ *
+ * There must be only exist one consumer but multiple producers may exist.
+ *
+ * @date   20261017
+ * @author Maximilian Seesslen <src@seesslen.net>
+ * @copyright SPDX-License-Identifier: Apache-2.0
+ *
+ *--------------------------------------------------------------------------*/
+
+
+/*--- Includes -------------------------------------------------------------*/
+
+
+#include <lepto/list.hpp>     // ringIndex_t, configs
+
+
+/*--- Definitions ----------------------------------------------------------*/
+
+
+template <typename T, ringIndex_t N>
+class CStaticRing
+{
+   static_assert( N > 0, "Capacity must not be 0" );
+   static_assert( N <= 0x7FFFFFFFu, "Capacity too big for ringIndex_t" );
+
+   private:
+      static constexpr bool POW2 = ( ( N & ( N - 1 ) ) == 0 );
+
+      #if ! IS_ENABLED( CONFIG_LEPTO_RING_NO_THREADS )
+      int m_busyProducing;
+      #endif
+      ringIndex_t m_frontPos;
+      ringIndex_t m_backPos;
+
+      #if IS_ENABLED( CONFIG_LEPTO_RING_SUPPORT_VOLATILE )
+      bool m_volatile;
+      #endif
+
+      T m_buffers[ N ];
+
+      static ringIndex_t next( ringIndex_t pos )
+      {
+         pos++;
+         if( ! POW2 && ( pos == 2 * N ) )
+         {
+            pos=0;
+         }
+         return( pos );
+      }
+
+      static ringIndex_t slot( ringIndex_t pos )
+      {
+         if( POW2 )
+         {
+            return( pos & ( N - 1 ) );
+         }
+         return( ( pos >= N ) ? ( pos - N ) : pos );
+      }
+
+      static int used( ringIndex_t front, ringIndex_t back )
+      {
+         if( POW2 || ( back >= front ) )
+         {
+            return( (int)( back - front ) );
+         }
+         return( (int)( back + 2 * N - front ) );
+      }
+
+   public:
+
+      constexpr CStaticRing()
+         :
+         #if ! IS_ENABLED( CONFIG_LEPTO_RING_NO_THREADS )
+         m_busyProducing(0),
+         #endif
+         m_frontPos(0)
+         ,m_backPos(0)
+         #if IS_ENABLED( CONFIG_LEPTO_RING_SUPPORT_VOLATILE )
+         ,m_volatile(false)
+         #endif
+         ,m_buffers{}
+      {
+      }
+
+      CStaticRing( const CStaticRing& ) = delete;
+      CStaticRing& operator=( const CStaticRing& ) = delete;
+
+      void clear()
+      {
+         m_frontPos=m_backPos=0;
+      }
+
+      /**
+       * @brief  Get the ammount of pushed/poppabel entries
+       */
+      int count() const
+      {
+         return( used( m_frontPos, m_backPos ) );
+      }
+
+      static constexpr int getMaxEntries()
+      {
+         return( N );
+      }
+
+      int getFreeCount() const
+      {
+         return( N - count() );
+      }
+
+      bool isFull() const
+      {
+         return( isFull( m_frontPos, m_backPos ) );
+      }
+
+      bool isFull( ringIndex_t front, ringIndex_t back ) const
+      {
+         return( used( front, back ) == (int)N );
+      }
+
+      bool pushable() const
+      {
+         return( ! isFull() );
+      }
+
+      /**
+       * @brief   Does the buffer contain pushed data, ignoring locks
+       */
+      bool isDataAvailableBasically() const
+      {
+         return( m_backPos != m_frontPos );
+      }
+
+      bool isDataAvailable() const
+      {
+         return( isDataAvailableBasically()
+            #if ! IS_ENABLED( CONFIG_LEPTO_RING_NO_THREADS )
+               && ( m_busyProducing == 0 )
+            #endif
+            );
+      }
+
+      ringIndex_t frontIndex() const
+      {
+         return( m_frontPos );
+      }
+
+      ringIndex_t backIndex() const
+      {
+         return( m_backPos );
+      }
+
+      /**
+       * @brief Get pointer to the entry at bottom position.
+       * @return Pointer to bottom entry or nullptr if no entries are available
+       */
+      T *frontEntry()
+      {
+         if( ! isDataAvailableBasically() )
+         {
+            return( nullptr );
+         }
+         return( &m_buffers[ slot( m_frontPos ) ] );
+      }
+
+      /**
+       * @brief Get pointer to the entry at top position.
+       * @return Pointer to top entry or nullptr if the buffer is full
+       */
+      T *backEntry()
+      {
+         if( isFull() )
+         {
+            return( nullptr );
+         }
+         return( &m_buffers[ slot( m_backPos ) ] );
+      }
+
+      T *getEntry( int pos )
+      {
+         if( pos >= count() )
+         {
+            return( nullptr );
+         }
+         ringIndex_t real=slot( m_frontPos ) + pos;
+         if( real >= N )
+         {
+            real -= N;
+         }
+         return( &m_buffers[ real ] );
+      }
+
+      /**
+       * @brief Drop the entry at bottom position.
+       */
+      void dropFront()
+      {
+         if( ! isDataAvailableBasically() )
+         {
+            lFatal("NE");
+         }
+         m_frontPos=next( m_frontPos );
+      }
+
+      /**
+       * @brief  Push the entry on the top index. Not thread safe.
+       */
+      void pushBack()
+      {
+         lAssert( pushable() );
+         m_backPos=next( m_backPos );
+      }
+
+      /**
+       * @brief   Reserve an entry that can be pushed later.
+       *          Same semantics as CList::tryReserve().
+       * @return  Slot of the reserved element or '-1' if buffer is full
+       */
+      ringIndex_t tryReserve()
+      {
+         bool valid;
+         ringIndex_t reserved;
+
+         #if ! IS_ENABLED( CONFIG_LEPTO_RING_NO_THREADS )
+            __atomic_add_fetch(&m_busyProducing, 1, __ATOMIC_SEQ_CST);
+         #endif
+
+         do{
+            reserved=m_backPos;
+            ringIndex_t front=m_frontPos;
+
+            if( isFull( front, reserved ) )
+            {
+               #if ! IS_ENABLED( CONFIG_LEPTO_RING_NO_THREADS )
+                  __atomic_sub_fetch(&m_busyProducing, 1, __ATOMIC_SEQ_CST);
+               #endif
+
+               return(-1);
+            }
+            valid=__atomic_compare_exchange_n( &m_backPos, &reserved, next( reserved ),
+                           true, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST );
+         }while(!valid);
+
+         return( slot( reserved ) );
+      }
+
+      /**
+       * @brief   Push an previously reserved entry
+       */
+      void pushReserved( ringIndex_t index )
+      {
+         (void)index;
+
+         #if ! IS_ENABLED( CONFIG_LEPTO_RING_NO_THREADS )
+            __atomic_sub_fetch( &m_busyProducing, 1, __ATOMIC_SEQ_CST);
+         #endif
+      }
+
+      /**
+       * @brief   Get pointer to an previously reserved entry
+       */
+      T* reservedEntry( ringIndex_t index )
+      {
+         if( index == (ringIndex_t)-1 )
+         {
+            return( nullptr );
+         }
+         return( &m_buffers[ index ] );
+      }
+
+      /**
+       * @brief   Just for internal testing
+       */
+      void setFrontBack( ringIndex_t front, ringIndex_t back )
+      {
+         m_frontPos=front;
+         m_backPos=back;
+      }
+
+      #if IS_ENABLED( CONFIG_LEPTO_RING_SUPPORT_VOLATILE )
+      void setVolatile( bool _volatile )
+      {
+         m_volatile=_volatile;
+      }
+      #endif
+
+      bool push_back( const T value )
+      {
+         #if IS_ENABLED( CONFIG_LEPTO_RING_SUPPORT_VOLATILE )
+         if( isFull() && m_volatile )
+         {
+            dropFront();
+         }
+         #endif
+
+         ringIndex_t index=tryReserve();
+
+         if( index == (ringIndex_t)-1 )
+         {
+            #if IS_ENABLED( CONFIG_LEPTO_LIST_ABORT_FAILING_PUSH )
+               abort();
+            #endif
+            return( false );
+         }
+         m_buffers[ index ]=value;
+         pushReserved( index );
+
+         return( true );
+      }
+
+      CStaticRing& operator << ( const T value )
+      {
+         push_back( value );
+         return( *this );
+      }
+
+      T pop()
+      {
+         T value{0};
+
+         if( isDataAvailable() )
+         {
+            value=*frontEntry();
+            dropFront();
+         }
+
+         return( value );
+      }
+};
+
+
+/*--- Fin ------------------------------------------------------------------*/
+#endif // ? ! LEPTO_STATIC_RING_HPP
@@ -0,0 +1,433 @@
+#ifndef LEPTO_STATS_RING_HPP
+#define LEPTO_STATS_RING_HPP
+/**---------------------------------------------------------------------------
+ *
+ * @file    statsRing.hpp
+ * @brief   Sliding window with statistics in constant time
+ *
+ * CStatsRing is a list of the last 'window' values. Pushing to a full window
+ * evicts the oldest value like a volatile CRing. While values enter and
+ * leave, the ring keeps
+ *    - the sum and the sum of squares, for average() and variance()
+ *    - two monotonic queues, for min() and max()
+ * so all of them are O(1) instead of walking the window.
+ *
+ * Floating point sums are recomputed once per window length to get rid of
+ * accumulated rounding errors.
+ *
+ * With FRACTION_BITS > 0 (integer types only) average() and variance() are
+ * fixed-point values scaled by 2^FRACTION_BITS and no floating point
+ * arithmetic is used at all.
+ *
+ * Integer samples may have up to 16 bits, or 32 bits where the compiler has
+ * 128 bit integers for the sum of squares. The values in the window are
+ * read-only; see getEntry() and begin().
+ *
+ * Not thread safe; push and read from one thread.
+ *
+ * Example:
+ *    CStatsRing<short> window(16);
+ *    window << sample;
+ *    printf( "%f %d\n", window.average(), window.max() );
+ *
+ *    CStatsRing<short, 8> window(16);          // Q.8 fixed-point
+ *    printf( "%lld\n", window.average() >> 8 );
+ *
+ * @date   20261017
+ * @author Maximilian Seesslen <src@seesslen.net>
+ * @copyright SPDX-License-Identifier: Apache-2.0
+ *
+ *--------------------------------------------------------------------------*/
+
+
+/*--- Includes -------------------------------------------------------------*/
+
+
+#include <lepto/list.hpp>
+
+
+/*--- Definitions ----------------------------------------------------------*/
+
+
+template <bool CONDITION, typename A, typename B> struct SStatsSelect { typedef A type; };
+template <typename A, typename B> struct SStatsSelect<false, A, B> { typedef B type; };
+
+#if defined( __SIZEOF_INT128__ )
+   typedef __int128 statsWide_t;
+   #define LEPTO_STATS_MAX_INTEGER_SIZE      4
+#else
+   typedef long long statsWide_t;
+   #define LEPTO_STATS_MAX_INTEGER_SIZE      2
+#endif
+
+/**
+ * @brief Type for the sum of squares; holds the square of 65536 samples
+ */
+template <typename T> struct SSquareAccumulator
+{
+   typedef typename SStatsSelect< ( sizeof( T ) <= 2 ), long long, statsWide_t >::type type;
+};
+template <> struct SSquareAccumulator<float>         { typedef double type; };
+template <> struct SSquareAccumulator<double>        { typedef double type; };
+template <> struct SSquareAccumulator<long double>   { typedef long double type; };
+
+
+/**
+ * @brief Monotonic queue of the window; the front is the minimum (or the
+ *        maximum) of the window.
+ */
+template <typename T, bool MAXIMUM>
+class CMonotonicQueue
+{
+   private:
+      struct SItem
+      {
+         T value;
+         unsigned int sequence;
+      };
+
+      SItem* m_items;
+      int m_capacity;
+      int m_head;
+      int m_size;
+
+      SItem& item( int pos ) const
+      {
+         pos+=m_head;
+         return( m_items[ ( pos >= m_capacity ) ? ( pos - m_capacity ) : pos ] );
+      }
+
+      // Entry at the back can never be the minimum/maximum again
+      bool superseded( const T& back, const T& value ) const
+      {
+         return( MAXIMUM ? !( value < back ) : !( back < value ) );
+      }
+
+   public:
+      CMonotonicQueue( int capacity )
+         :m_items( new SItem[ capacity ] )
+         ,m_capacity( capacity )
+         ,m_head( 0 )
+         ,m_size( 0 )
+      {
+      }
+
+      ~CMonotonicQueue()
+      {
+         delete[] m_items;
+      }
+
+      CMonotonicQueue( const CMonotonicQueue& ) = delete;
+      CMonotonicQueue& operator=( const CMonotonicQueue& ) = delete;
+
+      void push( const T& value, unsigned int sequence )
+      {
+         while( m_size && superseded( item( m_size - 1 ).value, value ) )
+         {
+            m_size--;
+         }
+         lAssert( m_size < m_capacity );
+         SItem& last=item( m_size );
+         last.value=value;
+         last.sequence=sequence;
+         m_size++;
+      }
+
+      /**
+       * @brief The value with 'sequence' left the window
+       */
+      void expire( unsigned int sequence )
+      {
+         if( m_size && ( m_items[ m_head ].sequence == sequence ) )
+         {
+            m_head=( m_head + 1 == m_capacity ) ? 0 : m_head + 1;
+            m_size--;
+         }
+      }
+
+      const T& front() const
+      {
+         return( m_items[ m_head ].value );
+      }
+
+      void clear()
+      {
+         m_head=m_size=0;
+      }
+};
+
+
+template <typename T, int FRACTION_BITS = 0>
+class CStatsRing: private CList<T>
+{
+   static_assert( ( FRACTION_BITS == 0 ) || ( ( (T)1 / 2 ) == 0 ),
+                  "Fixed-point mode is for integer types only" );
+   static_assert( ( FRACTION_BITS >= 0 ) && ( FRACTION_BITS <= 16 ),
+                  "The scaled sum of squares has to fit" );
+   static_assert( ( ( (T)1 / 2 ) != 0 ) || ( sizeof( T ) <= LEPTO_STATS_MAX_INTEGER_SIZE ),
+                  "The sum of squares of these samples would overflow" );
+
+   public:
+      typedef typename CList<T>::accumulator_t accumulator_t;
+      typedef typename SSquareAccumulator<T>::type square_t;
+
+      /**
+       * @brief Type of average() and variance(): double, or square_t
+       *        scaled by 2^FRACTION_BITS in fixed-point mode
+       */
+      typedef typename SStatsSelect< ( FRACTION_BITS > 0 ), square_t, double >::type stat_t;
+
+   private:
+      static constexpr long long SCALE = 1LL << FRACTION_BITS;
+
+      accumulator_t m_sum;
+      square_t m_sumSquares;
+      CMonotonicQueue<T, false> m_minimum;
+      CMonotonicQueue<T, true> m_maximum;
+      unsigned int m_frontSequence;
+      unsigned int m_backSequence;
+      int m_window;
+
+      static constexpr bool isFloatingPoint()
+      {
+         return( ( (T)1 / 2 ) != 0 );
+      }
+
+      void enter( const T& value )
+      {
+         m_sum+=value;
+         m_sumSquares+=(square_t)value * value;
+         m_minimum.push( value, m_backSequence );
+         m_maximum.push( value, m_backSequence );
+         m_backSequence++;
+
+         if( isFloatingPoint() && ( ( m_backSequence % m_window ) == 0 ) )
+         {
+            resync();
+         }
+      }
+
+      void leave( const T& value )
+      {
+         m_sum-=value;
+         m_sumSquares-=(square_t)value * value;
+         m_minimum.expire( m_frontSequence );
+         m_maximum.expire( m_frontSequence );
+         m_frontSequence++;
+      }
+
+      /**
+       * @brief Recompute the sums from the window
+       */
+      void resync()
+      {
+         typename CList<T>::SSpans spans=CList<T>::entrySpans();
+
+         m_sum=0;
+         m_sumSquares=0;
+         for( int i1=0; i1<spans.first.size; i1++ )
+         {
+            m_sum+=spans.first.data[i1];
+            m_sumSquares+=(square_t)spans.first.data[i1] * spans.first.data[i1];
+         }
+         for( int i1=0; i1<spans.second.size; i1++ )
+         {
+            m_sum+=spans.second.data[i1];
+            m_sumSquares+=(square_t)spans.second.data[i1] * spans.second.data[i1];
+         }
+      }
+
+   public:
+
+      /**
+       * @param window: Number of values the statistics are taken over
+       */
+      CStatsRing( int window )
+         :CList<T>( window + LEPTO_RING_SPARE_ENTRIES )
+         ,m_sum( 0 )
+         ,m_sumSquares( 0 )
+         ,m_minimum( window )
+         ,m_maximum( window )
+         ,m_frontSequence( 0 )
+         ,m_backSequence( 0 )
+         ,m_window( window )
+      {
+         lAssert( window > 0 );
+      }
+
+      typedef typename CList<T>::const_iterator const_iterator;
+
+      using CList<T>::count;
+      using CList<T>::isFull;
+      using CList<T>::isDataAvailable;
+
+      /**
+       * @brief Values of the window are read-only; writing them would
+       *        bypass the statistics
+       */
+      const T* getEntry( int pos ) const
+      {
+         return( CList<T>::getEntry( pos ) );
+      }
+
+      const_iterator begin() const
+      {
+         return( CList<T>::cbegin() );
+      }
+
+      const_iterator end() const
+      {
+         return( CList<T>::cend() );
+      }
+
+      int getWindow() const
+      {
+         return( m_window );
+      }
+
+      const T* frontEntry() const
+      {
+         return( CList<T>::frontEntry() );
+      }
+
+      /**
+       * @brief Push a value; the oldest one is evicted when the window is
+       *        full
+       */
+      bool push_back( const T& value )
+      {
+         if( isFull() )
+         {
+            dropFront();
+         }
+         if( ! CList<T>::push_back( value ) )
+         {
+            return( false );
+         }
+         enter( value );
+
+         return( true );
+      }
+
+      CStatsRing& operator << ( const T& value )
+      {
+         push_back( value );
+         return( *this );
+      }
+
+      void dropFront()
+      {
+         const T* front=CList<T>::frontEntry();
+
+         if( !front )
+         {
+            lFatal("NE");
+         }
+         leave( *front );
+         CList<T>::dropFront();
+      }
+
+      bool pop( T& value )
+      {
+         const T* front=CList<T>::frontEntry();
+
+         if( !front )
+         {
+            return( false );
+         }
+         value=*front;
+         dropFront();
+
+         return( true );
+      }
+
+      void clear()
+      {
+         CList<T>::clear();
+         m_minimum.clear();
+         m_maximum.clear();
+         m_sum=0;
+         m_sumSquares=0;
+         m_frontSequence=m_backSequence=0;
+      }
+
+      //--- Statistics; all O(1) --------------------------------------------
+
+      accumulator_t sum() const
+      {
+         return( m_sum );
+      }
+
+      /**
+       * @return Average of the window; 0 for an empty window
+       */
+      stat_t average() const
+      {
+         int n=count();
+
+         if( !n )
+         {
+            return( 0 );
+         }
+         if( FRACTION_BITS )
+         {
+            return( (stat_t)( ( (square_t)m_sum * SCALE ) / n ) );
+         }
+         return( (stat_t)m_sum / n );
+      }
+
+      /**
+       * @return Population variance of the window; 0 for an empty window
+       */
+      stat_t variance() const
+      {
+         int n=count();
+         stat_t value;
+
+         if( !n )
+         {
+            return( 0 );
+         }
+         if( ! isFloatingPoint() )
+         {
+            // Exact for integers: ( n * sum(x^2) - sum(x)^2 ) / n^2
+            statsWide_t numerator=(statsWide_t)n * m_sumSquares - (statsWide_t)m_sum * m_sum;
+            if( FRACTION_BITS )
+            {
+               value=(stat_t)( ( numerator * SCALE ) / ( (statsWide_t)n * n ) );
+            }
+            else
+            {
+               value=(stat_t)( (double)numerator / ( (double)n * n ) );
+            }
+         }
+         else
+         {
+            stat_t mean=(stat_t)m_sum / n;
+            value=(stat_t)m_sumSquares / n - mean * mean;
+         }
+
+         // Rounding may lead to tiny negative values
+         return( ( value < 0 ) ? 0 : value );
+      }
+
+      /**
+       * @return Smallest value of the window; T{} for an empty window
+       */
+      T min() const
+      {
+         return( count() ? m_minimum.front() : T{} );
+      }
+
+      /**
+       * @return Biggest value of the window; T{} for an empty window
+       */
+      T max() const
+      {
+         return( count() ? m_maximum.front() : T{} );
+      }
+};
+
+
+/*--- Fin ------------------------------------------------------------------*/
+#endif // ? ! LEPTO_STATS_RING_HPP
@@ -27,6 +27,11 @@ T&& doForward(typename remove_reference<T>::type& t) {
     return static_cast<T&&>(t);
 }
 
+template<typename T>
+typename remove_reference<T>::type&& doMove(T&& t) {
+    return static_cast<typename remove_reference<T>::type&&>(t);
+}
+
 template<typename... Ts>
 struct STuple;
 
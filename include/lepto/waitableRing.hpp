@@ -0,0 +1,247 @@
+#ifndef LEPTO_WAITABLE_RING_HPP
+#define LEPTO_WAITABLE_RING_HPP
+/**---------------------------------------------------------------------------
+ *
+ * @file    waitableRing.hpp
+ * @brief   CRing with blocking and timed waits for host threads
+ *
+ * Consumer threads on the host do not have to busy-poll isDataAvailable().
+ * They can park in waitForData() and producers can park in waitForSpace().
+ * Parking uses a futex. The other side only issues the wake syscall when
+ * somebody is actually parked. Otherwise a push/pop costs one additional
+ * atomic load.
+ *
+ * Only the methods of CWaitableRing notify. Pushing or popping via a
+ * reference to the CList base will not wake up parked threads.
+ *
+ * Example:
+ *    CWaitableRing<int> fifo(16);
+ *    fifo.push_back(0x10);                        // Producer thread
+ *    if( fifo.waitForData( 100 ) )                // Consumer thread
+ *       printf( "Entry: 0x%X\n", fifo.pop() );
+ *
+ * Linux only.
+ *
+ * @date   20261017
+ * @author Maximilian Seesslen <src@seesslen.net>
+ * @copyright SPDX-License-Identifier: Apache-2.0
+ *
+ *--------------------------------------------------------------------------*/
+
+
+/*--- Includes -------------------------------------------------------------*/
+
+
+#include <lepto/ring.hpp>
+
+#if ! defined( __linux__ )
+   #error CWaitableRing is only available on linux hosts
+#endif
+
+
+/*--- Definitions ----------------------------------------------------------*/
+
+
+/**
+ * @brief Wait till '*word' is no longer 'expected'. Returns after at most
+ *        'timeoutMs' milliseconds; '-1' waits forever.
+ */
+void leptoFutexWait( int* word, int expected, int timeoutMs );
+
+/**
+ * @brief Wake up all threads waiting on 'word'
+ */
+void leptoFutexWake( int* word );
+
+/**
+ * @brief Monotonic time in milliseconds
+ */
+long long leptoMonotonicMs();
+
+
+template <typename T>
+class CWaitableRing: public CRing<T>
+{
+   private:
+      int m_dataEvent=0;
+      int m_spaceEvent=0;
+      int m_dataWaiters=0;
+      int m_spaceWaiters=0;
+
+      static void notify( int* event, int* waiters )
+      {
+         if( __atomic_load_n( waiters, __ATOMIC_SEQ_CST ) )
+         {
+            __atomic_add_fetch( event, 1, __ATOMIC_SEQ_CST );
+            leptoFutexWake( event );
+         }
+      }
+
+      template <typename C>
+      bool wait( int* event, int* waiters, int timeoutMs, C condition )
+      {
+         if( condition() )
+         {
+            return( true );
+         }
+
+         long long deadline=leptoMonotonicMs() + timeoutMs;
+         while( true )
+         {
+            int remaining=-1;
+            if( timeoutMs >= 0 )
+            {
+               remaining=(int)( deadline - leptoMonotonicMs() );
+               if( remaining <= 0 )
+               {
+                  return( condition() );
+               }
+            }
+
+            __atomic_add_fetch( waiters, 1, __ATOMIC_SEQ_CST );
+            int expected=__atomic_load_n( event, __ATOMIC_SEQ_CST );
+            // The other side checks for waiters after changing the state.
+            // Check again after announcing to not miss the wakeup.
+            if( condition() )
+            {
+               __atomic_sub_fetch( waiters, 1, __ATOMIC_SEQ_CST );
+               return( true );
+            }
+            leptoFutexWait( event, expected, remaining );
+            __atomic_sub_fetch( waiters, 1, __ATOMIC_SEQ_CST );
+
+            if( condition() )
+            {
+               return( true );
+            }
+         }
+      }
+
+      void notifyData()
+      {
+         notify( &m_dataEvent, &m_dataWaiters );
+      }
+
+      void notifySpace()
+      {
+         notify( &m_spaceEvent, &m_spaceWaiters );
+      }
+
+   public:
+
+      CWaitableRing( int maxEntries = CONFIG_LEPTO_RING_DEFAULT_SIZE,
+                     CMemoryResource* resource = nullptr )
+         :CRing<T>( maxEntries, resource )
+      {
+      }
+
+      /**
+       * @brief   Wait till data can be consumed
+       * @param   timeoutMs: Milliseconds to wait at most; '-1' for ever
+       * @return  true: isDataAvailable() is true
+       */
+      bool waitForData( int timeoutMs = -1 )
+      {
+         return( wait( &m_dataEvent, &m_dataWaiters, timeoutMs,
+                       [this](){ return( this->isDataAvailable() ); } ) );
+      }
+
+      /**
+       * @brief   Wait till an entry can be pushed
+       * @param   timeoutMs: Milliseconds to wait at most; '-1' for ever
+       * @return  true: pushable() is true
+       */
+      bool waitForSpace( int timeoutMs = -1 )
+      {
+         return( wait( &m_spaceEvent, &m_spaceWaiters, timeoutMs,
+                       [this](){ return( this->pushable() ); } ) );
+      }
+
+      //--- Producer side ---------------------------------------------------
+
+      bool push_back( const T& value )
+      {
+         bool pushed=CRing<T>::push_back( value );
+         notifyData();
+         return( pushed );
+      }
+
+      bool push_back( T&& value )
+      {
+         bool pushed=CRing<T>::push_back( doMove( value ) );
+         notifyData();
+         return( pushed );
+      }
+
+      template <typename... Args>
+      bool emplace_back( Args&&... args )
+      {
+         bool pushed=CRing<T>::emplace_back( doForward<Args>( args )... );
+         notifyData();
+         return( pushed );
+      }
+
+      CWaitableRing& operator << ( const T& value )
+      {
+         push_back( value );
+         return( *this );
+      }
+
+      void pushReserved( ringIndex_t index )
+      {
+         CRing<T>::pushReserved( index );
+         notifyData();
+      }
+
+      void pushBack()
+      {
+         CRing<T>::pushBack();
+         notifyData();
+      }
+
+      int pushBulk( const T* values, int n )
+      {
+         int pushed=CRing<T>::pushBulk( values, n );
+         notifyData();
+         return( pushed );
+      }
+
+      //--- Consumer side ---------------------------------------------------
+
+      void dropFront()
+      {
+         CRing<T>::dropFront();
+         notifySpace();
+      }
+
+      T pop()
+      {
+         T value=CRing<T>::pop();
+         notifySpace();
+         return( value );
+      }
+
+      bool pop( T& value )
+      {
+         bool popped=CRing<T>::pop( value );
+         notifySpace();
+         return( popped );
+      }
+
+      int popBulk( T* values, int n )
+      {
+         int popped=CRing<T>::popBulk( values, n );
+         notifySpace();
+         return( popped );
+      }
+
+      void commit( int n )
+      {
+         CRing<T>::commit( n );
+         notifySpace();
+      }
+};
+
+
+/*--- Fin ------------------------------------------------------------------*/
+#endif // ? ! LEPTO_WAITABLE_RING_HPP
@@ -32,6 +32,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <lepto/ring.hpp>
+#include <lepto/staticRing.hpp>
 
 #if IS_ENABLED( CONFIG_LEPTO_LOG_PRETTY_PRINT ) || IS_ENABLED( CONFIG_LEPTO_LOG_ANSI_COLORS )
 #include <lepto/ansi.h>
@@ -53,7 +54,8 @@ the same time does not make sense.
 #if ! IS_ENABLED( CONFIG_LEPTO_LOG_DIRECT_PRINT )
    
    #if 1
-      static CRing<SLogEntry> logs( CONFIG_LEPTO_LOG_MAX_ENTRIES );
+      // Slots are part of the object; no allocation, no startup cost
+      static CStaticRing<SLogEntry, CONFIG_LEPTO_LOG_MAX_ENTRIES> logs;
       void leptoInitLog()
       {
       }
@@ -0,0 +1,186 @@
+/**---------------------------------------------------------------------------
+ *
+ * @file    memoryResource.cpp
+ * @brief   Bundled memory resources
+ *
+ * @date   20261017
+ * @author Maximilian Seesslen <src@seesslen.net>
+ * @copyright SPDX-License-Identifier: Apache-2.0
+ *
+ *--------------------------------------------------------------------------*/
+
+
+/*--- Includes -------------------------------------------------------------*/
+
+
+#include <lepto/memoryResource.hpp>
+#include <lepto/log.h>
+#include <new>
+
+#if defined( __linux__ )
+   #include <sys/mman.h>
+#endif
+
+
+/*--- Implementation -------------------------------------------------------*/
+
+
+void* CStaticBufferResource::allocate( size_t size, size_t alignment )
+{
+   size_t used=__atomic_load_n( &m_used, __ATOMIC_RELAXED );
+   size_t start;
+
+   do
+   {
+      start=alignUp( (uintptr_t)m_buffer + used, alignment ) - (uintptr_t)m_buffer;
+      if( ( start + size ) > m_size )
+      {
+         return( nullptr );
+      }
+   }while( ! __atomic_compare_exchange_n( &m_used, &used, start + size, true,
+                                          __ATOMIC_RELAXED, __ATOMIC_RELAXED ) );
+
+   return( m_buffer + start );
+}
+
+
+void CStaticBufferResource::deallocate( void* p, size_t size, size_t alignment )
+{
+   (void)alignment;
+   size_t end=( (char*)p - m_buffer ) + size;
+   size_t start=(char*)p - m_buffer;
+
+   // Only the top allocation can be given back
+   __atomic_compare_exchange_n( &m_used, &end, start, false,
+                                __ATOMIC_RELAXED, __ATOMIC_RELAXED );
+}
+
+
+void* CMonotonicResource::allocateUpstream( size_t size )
+{
+   if( m_upstream )
+   {
+      return( m_upstream->allocate( size, alignof( SChunk ) ) );
+   }
+   return( ::operator new( size, std::nothrow ) );
+}
+
+
+void CMonotonicResource::freeUpstream( void* p, size_t size )
+{
+   if( m_upstream )
+   {
+      m_upstream->deallocate( p, size, alignof( SChunk ) );
+   }
+   else
+   {
+      ::operator delete( p );
+   }
+}
+
+
+void* CMonotonicResource::allocate( size_t size, size_t alignment )
+{
+   uintptr_t start=alignUp( (uintptr_t)m_current, alignment );
+
+   if( !m_current || ( start + size ) > ( (uintptr_t)m_current + m_left ) )
+   {
+      // Big requests get a chunk of their own
+      size_t chunkSize=MAX( m_chunkSize, sizeof( SChunk ) + size + alignment );
+      SChunk* chunk=(SChunk*)allocateUpstream( chunkSize );
+
+      if( !chunk )
+      {
+         return( nullptr );
+      }
+      chunk->next=m_chunks;
+      chunk->size=chunkSize;
+      m_chunks=chunk;
+      m_current=(char*)( chunk + 1 );
+      m_left=chunkSize - sizeof( SChunk );
+      start=alignUp( (uintptr_t)m_current, alignment );
+   }
+
+   m_left-=( start + size ) - (uintptr_t)m_current;
+   m_current=(char*)( start + size );
+
+   return( (void*)start );
+}
+
+
+void CMonotonicResource::deallocate( void* p, size_t size, size_t alignment )
+{
+   // Freed at once by release()
+   (void)p;
+   (void)size;
+   (void)alignment;
+}
+
+
+void CMonotonicResource::release()
+{
+   while( m_chunks )
+   {
+      SChunk* next=m_chunks->next;
+      freeUpstream( m_chunks, m_chunks->size );
+      m_chunks=next;
+   }
+   m_current=nullptr;
+   m_left=0;
+}
+
+
+#if defined( __linux__ )
+
+void* CHugePageResource::allocate( size_t size, size_t alignment )
+{
+   size_t length=mappingSize( size );
+   void* p;
+
+   // Mappings are page aligned; more is not supported
+   lAssert( alignment <= m_pageSize );
+
+   p=mmap( nullptr, length, PROT_READ | PROT_WRITE,
+           MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0 );
+   if( p != MAP_FAILED )
+   {
+      __atomic_add_fetch( &m_hugeMappings, 1, __ATOMIC_RELAXED );
+      return( p );
+   }
+
+   // Regular mappings are only aligned to the small pages; map one huge
+   // page more and trim it to get the same alignment as above
+   p=mmap( nullptr, length + m_pageSize, PROT_READ | PROT_WRITE,
+           MAP_PRIVATE | MAP_ANONYMOUS, -1, 0 );
+   if( p == MAP_FAILED )
+   {
+      return( nullptr );
+   }
+   char* start=(char*)p;
+   char* aligned=(char*)alignUp( (uintptr_t)p, m_pageSize );
+   if( aligned > start )
+   {
+      munmap( start, aligned - start );
+   }
+   if( aligned + length < start + length + m_pageSize )
+   {
+      munmap( aligned + length, ( start + m_pageSize ) - aligned );
+   }
+   p=aligned;
+   madvise( p, length, MADV_HUGEPAGE );
+   __atomic_add_fetch( &m_fallbackMappings, 1, __ATOMIC_RELAXED );
+
+   return( p );
+}
+
+
+void CHugePageResource::deallocate( void* p, size_t size, size_t alignment )
+{
+   (void)alignment;
+   munmap( p, mappingSize( size ) );
+}
+
+#endif // ? __linux__
+
+
+/*--- Fin ------------------------------------------------------------------*/
@@ -0,0 +1,189 @@
+/**---------------------------------------------------------------------------
+ *
+ * @file    shmRing.cpp
+ * @brief   Shared memory mapping for CShmRing
+ *
+ * @date   20261017
+ * @author Maximilian Seesslen <src@seesslen.net>
+ * @copyright SPDX-License-Identifier: Apache-2.0
+ *
+ *--------------------------------------------------------------------------*/
+
+
+/*--- Includes -------------------------------------------------------------*/
+
+
+#if defined( __linux__ )
+
+#include <lepto/shmRing.hpp>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <string.h>
+
+
+/*--- Implementation -------------------------------------------------------*/
+
+
+CShmMapping::CShmMapping()
+   :m_header(nullptr)
+   ,m_size(0)
+   ,m_fd(-1)
+   ,m_ownerPid(0)
+{
+   m_name[0]=0;
+}
+
+
+CShmMapping::~CShmMapping()
+{
+   detach();
+}
+
+
+bool CShmMapping::map( int fd, size_t size )
+{
+   void* p=mmap( nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0 );
+
+   if( p == MAP_FAILED )
+   {
+      return( false );
+   }
+   m_header=(SHeader*)p;
+   m_size=size;
+   m_fd=fd;
+
+   return( true );
+}
+
+
+bool CShmMapping::create( const char* name, uint32_t entrySize, int maxEntries )
+{
+   int fd;
+   size_t size=headerSize() + (size_t)entrySize * maxEntries;
+
+   lAssert( maxEntries > 0 );
+   detach();
+
+   if( name )
+   {
+      if( strlen( name ) >= sizeof( m_name ) )
+      {
+         return( false );
+      }
+      fd=shm_open( name, O_RDWR | O_CREAT | O_EXCL, 0600 );
+   }
+   else
+   {
+      fd=memfd_create( "lepto-ring", MFD_CLOEXEC );
+   }
+   if( fd < 0 )
+   {
+      return( false );
+   }
+
+   if( ( ftruncate( fd, size ) != 0 ) || ! map( fd, size ) )
+   {
+      close( fd );
+      if( name )
+      {
+         shm_unlink( name );
+      }
+      return( false );
+   }
+
+   if( name )
+   {
+      strcpy( m_name, name );
+      m_ownerPid=getpid();
+   }
+
+   // The mapping is zeroed; indices and busy counter start at 0
+   m_header->entrySize=entrySize;
+   m_header->maxEntries=maxEntries;
+   m_header->wrap=maxEntries * MIN( 0x10000, (int)( 0x7FFFFFFF / maxEntries ) );
+   // Attaching processes check the magic last
+   __atomic_store_n( &m_header->magic, MAGIC, __ATOMIC_RELEASE );
+
+   return( true );
+}
+
+
+bool CShmMapping::attachFd( int fd, uint32_t entrySize )
+{
+   struct stat status;
+
+   if( ( fstat( fd, &status ) != 0 ) || ( (size_t)status.st_size < headerSize() ) )
+   {
+      return( false );
+   }
+   detach();
+   if( ! map( fd, status.st_size ) )
+   {
+      return( false );
+   }
+
+   if( ( __atomic_load_n( &m_header->magic, __ATOMIC_ACQUIRE ) != MAGIC )
+       || ( m_header->entrySize != entrySize )
+       || ( headerSize() + (size_t)entrySize * m_header->maxEntries > m_size ) )
+   {
+      // Not initialized yet or another type
+      munmap( m_header, m_size );
+      m_header=nullptr;
+      m_fd=-1;
+      return( false );
+   }
+
+   return( true );
+}
+
+
+bool CShmMapping::attach( const char* name, uint32_t entrySize )
+{
+   int fd=shm_open( name, O_RDWR, 0 );
+
+   if( fd < 0 )
+   {
+      return( false );
+   }
+   if( ! attachFd( fd, entrySize ) )
+   {
+      close( fd );
+      return( false );
+   }
+
+   return( true );
+}
+
+
+void CShmMapping::detach()
+{
+   if( m_header )
+   {
+      munmap( m_header, m_size );
+      m_header=nullptr;
+   }
+   if( m_fd >= 0 )
+   {
+      close( m_fd );
+      m_fd=-1;
+   }
+   if( m_ownerPid == getpid() )
+   {
+      shm_unlink( m_name );
+   }
+   m_ownerPid=0;
+   m_name[0]=0;
+}
+
+
+bool CShmMapping::unlink( const char* name )
+{
+   return( shm_unlink( name ) == 0 );
+}
+
+#endif // ? __linux__
+
+
+/*--- Fin ------------------------------------------------------------------*/
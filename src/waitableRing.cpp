@@ -0,0 +1,62 @@
+/**---------------------------------------------------------------------------
+ *
+ * @file    waitableRing.cpp
+ * @brief   Futex helpers for CWaitableRing
+ *
+ * @date   20261017
+ * @author Maximilian Seesslen <src@seesslen.net>
+ * @copyright SPDX-License-Identifier: Apache-2.0
+ *
+ *--------------------------------------------------------------------------*/
+
+
+/*--- Includes -------------------------------------------------------------*/
+
+
+#if defined( __linux__ )
+
+#include <lepto/waitableRing.hpp>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <limits.h>
+#include <time.h>
+
+
+/*--- Implementation -------------------------------------------------------*/
+
+
+void leptoFutexWait( int* word, int expected, int timeoutMs )
+{
+   struct timespec timeout;
+   struct timespec* pTimeout=nullptr;
+
+   if( timeoutMs >= 0 )
+   {
+      timeout.tv_sec=timeoutMs / 1000;
+      timeout.tv_nsec=( timeoutMs % 1000 ) * 1000000L;
+      pTimeout=&timeout;
+   }
+
+   // Spurious wakeups and EAGAIN are fine; the caller checks its condition
+   syscall( SYS_futex, word, FUTEX_WAIT_PRIVATE, expected, pTimeout, nullptr, 0 );
+}
+
+
+void leptoFutexWake( int* word )
+{
+   syscall( SYS_futex, word, FUTEX_WAKE_PRIVATE, INT_MAX, nullptr, nullptr, 0 );
+}
+
+
+long long leptoMonotonicMs()
+{
+   struct timespec now;
+   clock_gettime( CLOCK_MONOTONIC, &now );
+   return( ( (long long)now.tv_sec * 1000 ) + ( now.tv_nsec / 1000000 ) );
+}
+
+#endif // ? __linux__
+
+
+/*--- Fin ------------------------------------------------------------------*/
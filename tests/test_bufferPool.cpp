@@ -0,0 +1,158 @@
+/**---------------------------------------------------------------------------
+ *
+ * @file       test_bufferPool.cpp
+ * @brief      Test the buffer pool
+ *
+ * @date       20261017
+ * @author     Maximilian Seesslen <src@seesslen.net>
+ * @copyright  SPDX-License-Identifier: Apache-2.0
+ *
+ *--------------------------------------------------------------------------*/
+
+
+/*--- Includes -------------------------------------------------------------*/
+
+
+#if defined ( CATCH_V3 )
+   #include <catch2/catch_test_macros.hpp>
+#elif defined ( CATCH_V2 )
+   #include <catch2/catch.hpp>
+#elif defined ( CATCH_V1 )
+   #include <catch/catch.hpp>
+#else
+   #error "Either 'catch' or 'catch2' has to be installed"
+#endif
+
+#include <lepto/bufferPool.hpp>
+#include <lepto/ringSpsc.hpp>
+#include <string.h>
+#include <thread>
+
+
+/*--- Implementation -------------------------------------------------------*/
+
+
+TEST_CASE( "Buffer pool", "[default]" )
+{
+   SECTION( "Acquire and release" )
+   {
+      CBufferPool pool( 100, 4, nullptr, 64 );
+      char* arena=(char*)pool.getArena();
+      CBufferHandle handles[ 4 ];
+
+      REQUIRE( ( (size_t)arena % 64 ) == 0 );
+      REQUIRE( pool.getArenaSize() == 4 * 128 );
+      for( int i1=0; i1<4; i1++ )
+      {
+         handles[i1]=pool.acquire();
+         REQUIRE( handles[i1] );
+         REQUIRE( handles[i1].data() == arena + handles[i1].index() * 128 );
+         REQUIRE( handles[i1].size() == 100 );
+      }
+      REQUIRE( pool.getFree() == 0 );
+      REQUIRE( ! pool.acquire() );
+      REQUIRE( pool.acquireIndex() == -1 );
+      REQUIRE( pool.getExhausted() == 2 );
+
+      // Any order
+      int index=handles[2].index();
+      handles[2].reset();
+      handles[0].reset();
+      REQUIRE( pool.getUsed() == 2 );
+      REQUIRE( pool.getHighWater() == 4 );
+      // Last released on top
+      handles[0]=pool.acquire();
+      REQUIRE( handles[0].index() == 0 );
+      REQUIRE( pool.acquireIndex() == index );
+      pool.release( index );
+
+      pool.resetStatistics();
+      REQUIRE( pool.getHighWater() == 3 );
+      REQUIRE( pool.getExhausted() == 0 );
+   }
+
+   SECTION( "Reference count" )
+   {
+      CBufferPool pool( 32, 2 );
+      CBufferHandle first=pool.acquire();
+
+      {
+         CBufferHandle copy=first;
+         CBufferHandle other;
+         other=copy;
+         REQUIRE( first.getRefCount() == 3 );
+      }
+      REQUIRE( first.getRefCount() == 1 );
+
+      CBufferHandle moved=doMove( first );
+      REQUIRE( ! first );
+      REQUIRE( moved.getRefCount() == 1 );
+      REQUIRE( pool.getUsed() == 1 );
+      moved=CBufferHandle();
+      REQUIRE( pool.getUsed() == 0 );
+   }
+
+   SECTION( "Handles through a ring" )
+   {
+      CBufferPool pool( 32, 4 );
+      CSpscRing<int> packets( 4 );
+
+      for( int i1=0; i1<3; i1++ )
+      {
+         CBufferHandle packet=pool.acquire();
+         memset( packet.data(), 'a' + i1, 32 );
+         REQUIRE( packets.push_back( packet.detach() ) );
+      }
+      REQUIRE( pool.getUsed() == 3 );
+      for( int i1=0; i1<3; i1++ )
+      {
+         CBufferHandle packet=pool.adopt( packets.pop() );
+         REQUIRE( packet.getRefCount() == 1 );
+         REQUIRE( ( (char*)packet.data() )[31] == 'a' + i1 );
+      }
+      REQUIRE( pool.getUsed() == 0 );
+   }
+
+   SECTION( "Threaded" )
+   {
+      const int THREADS=4;
+      const int ROUNDS=100000;
+      CBufferPool pool( sizeof( int ), 8 );
+      std::thread threads[ THREADS ];
+      bool valid[ THREADS ];
+
+      for( int i1=0; i1<THREADS; i1++ )
+      {
+         threads[i1]=std::thread( [&pool, &valid, i1]()
+         {
+            valid[i1]=true;
+            for( int i2=0; i2<ROUNDS; i2++ )
+            {
+               CBufferHandle first=pool.acquire();
+               CBufferHandle second=pool.acquire();
+               if( !first || !second )
+               {
+                  continue;
+               }
+               // Nobody else may own them
+               *(int*)first.data()=i1 * ROUNDS + i2;
+               *(int*)second.data()=-( i1 * ROUNDS + i2 );
+               CBufferHandle shared=second;
+               valid[i1]&=( *(int*)first.data() == i1 * ROUNDS + i2 );
+               valid[i1]&=( *(int*)shared.data() == -( i1 * ROUNDS + i2 ) );
+            }
+         } );
+      }
+      for( int i1=0; i1<THREADS; i1++ )
+      {
+         threads[i1].join();
+         REQUIRE( valid[i1] );
+      }
+      REQUIRE( pool.getUsed() == 0 );
+      REQUIRE( pool.getHighWater() >= 2 );
+      REQUIRE( pool.getHighWater() <= 8 );
+   }
+}
+
+
+/*--- Fin ------------------------------------------------------------------*/
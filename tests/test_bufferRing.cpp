@@ -0,0 +1,323 @@
+/**---------------------------------------------------------------------------
+ *
+ * @file       test_bufferRing.cpp
+ * @brief      Test CBufferRing
+ *
+ * @date       20261017
+ * @author     Maximilian Seesslen <src@seesslen.net>
+ * @copyright  SPDX-License-Identifier: Apache-2.0
+ *
+ *--------------------------------------------------------------------------*/
+
+
+/*--- Includes -------------------------------------------------------------*/
+
+
+#if defined ( CATCH_V3 )
+   #include <catch2/catch_test_macros.hpp>
+#elif defined ( CATCH_V2 )
+   #include <catch2/catch.hpp>
+#elif defined ( CATCH_V1 )
+   #include <catch/catch.hpp>
+#else
+   #error "Either 'catch' or 'catch2' has to be installed"
+#endif
+
+#include <lepto/bufferRing.hpp>
+#include <lepto/recordRing.hpp>
+#include <thread>
+#include <chrono>
+
+#if defined( __linux__ )
+   #include <unistd.h>
+#endif
+
+
+/*--- Implementation -------------------------------------------------------*/
+
+
+TEST_CASE( "Buffer ring", "[default]" )
+{
+   SECTION( "Push and drop" )
+   {
+      CBufferRing ring( 64, 4 );
+      void* data;
+
+      REQUIRE( ring.getMaxBufferSize() == 64 );
+      REQUIRE( ring.getBottomData() == nullptr );
+      REQUIRE( ring.usedBuffers() == 0 );
+
+      for( int i1=0; i1<4; i1++ )
+      {
+         REQUIRE( ( data = ring.pushBuffer( 10 + i1 ) ) != nullptr );
+         memset( data, 'a' + i1, 10 + i1 );
+      }
+      REQUIRE( ring.pushBuffer( 1 ) == nullptr );
+      REQUIRE( ring.usedBuffers() == 4 );
+
+      for( int i1=0; i1<4; i1++ )
+      {
+         REQUIRE( ring.getBottomSize() == 10 + i1 );
+         REQUIRE( ( (char*)ring.getBottomData() )[ 9 + i1 ] == 'a' + i1 );
+         ring.dropBuffer();
+      }
+      REQUIRE( ring.getBottomData() == nullptr );
+   }
+
+   SECTION( "Contiguous arena" )
+   {
+      CBufferRing ring( 100, 8, nullptr, 64 );
+      char* arena=(char*)ring.getArena();
+
+      REQUIRE( ( (size_t)arena % 64 ) == 0 );
+      REQUIRE( ring.getArenaSize() == 8 * 128 );
+      for( int i1=0; i1<8; i1++ )
+      {
+         void* data=ring.pushBuffer( 1 );
+         REQUIRE( data == arena + i1 * 128 );
+      }
+   }
+
+   SECTION( "Reserve and commit" )
+   {
+      CBufferRing ring( 32, 2 );
+      SBufferSpan span;
+
+      REQUIRE( ring.readSpan().data == nullptr );
+      for( int i1=0; i1<2; i1++ )
+      {
+         span=ring.reserveWrite();
+         REQUIRE( span.data != nullptr );
+         REQUIRE( span.size == 32 );
+         // Not visible before the commit
+         REQUIRE( ring.usedBuffers() == i1 );
+         memset( span.data, '0' + i1, 5 );
+         ring.commitWrite( 5 );
+      }
+      REQUIRE( ring.reserveWrite().data == nullptr );
+
+      for( int i1=0; i1<2; i1++ )
+      {
+         span=ring.readSpan();
+         REQUIRE( span.size == 5 );
+         REQUIRE( ( (char*)span.data )[4] == '0' + i1 );
+         ring.commitRead();
+      }
+      REQUIRE( ring.readSpan().data == nullptr );
+      REQUIRE( ring.reserveWrite().data != nullptr );
+   }
+
+   SECTION( "Vectors" )
+   {
+      CBufferRing ring( 16, 4 );
+      bufferVector_t vectors[ 4 ];
+
+      // Wrapped around
+      ring.pushBuffer( 1 );
+      ring.pushBuffer( 1 );
+      ring.commitRead( 2 );
+
+      REQUIRE( ring.reserveWriteVectors( vectors, 4 ) == 4 );
+      REQUIRE( vectors[0].iov_len == 16 );
+      REQUIRE( ring.commitWriteBytes( -1 ) == 0 );
+      REQUIRE( ring.commitWriteBytes( 0 ) == 0 );
+      REQUIRE( ring.usedBuffers() == 0 );
+      REQUIRE( ring.commitWriteBytes( 40 ) == 3 );
+      REQUIRE( ring.usedBuffers() == 3 );
+      REQUIRE( ring.reserveWriteVectors( vectors, 4 ) == 1 );
+
+      REQUIRE( ring.readVectors( vectors, 2 ) == 2 );
+      REQUIRE( ring.readVectors( vectors, 4 ) == 3 );
+      REQUIRE( vectors[0].iov_len == 16 );
+      REQUIRE( vectors[1].iov_len == 16 );
+      REQUIRE( vectors[2].iov_len == 8 );
+      ring.commitRead( -1 );
+      ring.commitRead( 0 );
+      REQUIRE( ring.usedBuffers() == 3 );
+      ring.commitRead( 3 );
+      REQUIRE( ring.readVectors( vectors, 4 ) == 0 );
+
+      // More than fits; only the free buffers are published
+      REQUIRE( ring.commitWriteBytes( 1000 ) == 4 );
+      REQUIRE( ring.usedBuffers() == 4 );
+      REQUIRE( ring.commitWriteBytes( 16 ) == 0 );
+   }
+
+   #if IS_ENABLED( CONFIG_LEPTO_BUFFER_RING_TIMESTAMPS )
+   SECTION( "Latency" )
+   {
+      CBufferRing ring( 16, 4 );
+      bufferVector_t vectors[ 4 ];
+
+      REQUIRE( ring.getLatency().count == 0 );
+      REQUIRE( ring.getLatency().average() == 0 );
+
+      ring.pushBuffer( 1 );
+      ring.pushBuffer( 1 );
+      std::this_thread::sleep_for( std::chrono::milliseconds( 20 ) );
+      ring.pushBuffer( 1 );
+      ring.dropBuffer();
+      REQUIRE( ring.readVectors( vectors, 4 ) == 2 );
+      ring.commitRead( 2 );
+
+      const SBufferLatency& latency=ring.getLatency();
+      REQUIRE( latency.count == 3 );
+      REQUIRE( latency.min < 20000 );
+      REQUIRE( latency.max >= 20000 );
+      REQUIRE( latency.average() >= latency.min );
+      REQUIRE( latency.average() <= latency.max );
+
+      unsigned int counted=0;
+      for( int i1=0; i1<CONFIG_LEPTO_BUFFER_RING_LATENCY_BUCKETS; i1++ )
+      {
+         counted+=latency.histogram[i1];
+      }
+      REQUIRE( counted == 3 );
+      // 20ms and more
+      REQUIRE( latency.histogram[ 15 ] + latency.histogram[ 16 ] >= 2 );
+
+      ring.resetLatency();
+      REQUIRE( ring.getLatency().count == 0 );
+   }
+   #endif
+
+   #if defined( __linux__ )
+   SECTION( "Pipe" )
+   {
+      CBufferRing source( 32, 8 );
+      CBufferRing sink( 32, 8 );
+      bufferVector_t vectors[ 8 ];
+      int fds[ 2 ];
+
+      for( int i1=0; i1<5; i1++ )
+      {
+         memset( source.pushBuffer( 32 ), 'a' + i1, 32 );
+      }
+      REQUIRE( pipe( fds ) == 0 );
+
+      int buffers=source.readVectors( vectors, 8 );
+      REQUIRE( writev( fds[1], vectors, buffers ) == 5 * 32 );
+      source.commitRead( buffers );
+      REQUIRE( source.usedBuffers() == 0 );
+
+      buffers=sink.reserveWriteVectors( vectors, 8 );
+      REQUIRE( sink.commitWriteBytes( readv( fds[0], vectors, buffers ) ) == 5 );
+      for( int i1=0; i1<5; i1++ )
+      {
+         REQUIRE( sink.getBottomSize() == 32 );
+         REQUIRE( ( (char*)sink.getBottomData() )[31] == 'a' + i1 );
+         sink.dropBuffer();
+      }
+      close( fds[0] );
+      close( fds[1] );
+   }
+   #endif
+}
+
+
+TEST_CASE( "Record ring", "[default]" )
+{
+   SECTION( "Variable sizes" )
+   {
+      CRecordRing ring( 64 );
+      char text[ 64 ];
+
+      REQUIRE( ring.peek().data == nullptr );
+      REQUIRE( ring.getMaxRecordSize() == 28 );
+      REQUIRE( ring.push( "a", 2 ) );                 // 8 bytes
+      REQUIRE( ring.push( "hello world", 12 ) );      // 16 bytes
+      REQUIRE( ring.getUsed() == 24 );
+
+      // Reserve more than used
+      char* record=(char*)ring.reserve( 30 );
+      REQUIRE( record != nullptr );
+      strcpy( record, "abc" );
+      REQUIRE( ring.isDataAvailable() );
+      ring.commit( 4 );                               // 8 bytes
+      REQUIRE( ring.getUsed() == 32 );
+
+      // A failed snprintf() cancels the reservation
+      REQUIRE( ring.reserve( 8 ) != nullptr );
+      ring.commit( -1 );
+      REQUIRE( ring.getUsed() == 32 );
+
+      REQUIRE( ring.pop( text, sizeof( text ) ) == 2 );
+      REQUIRE( strcmp( text, "a" ) == 0 );
+      SRecord peeked=ring.peek();
+      REQUIRE( peeked.size == 12 );
+      REQUIRE( strcmp( (const char*)peeked.data, "hello world" ) == 0 );
+      ring.release();
+      REQUIRE( ring.pop( text, sizeof( text ) ) == 4 );
+      REQUIRE( strcmp( text, "abc" ) == 0 );
+      REQUIRE( ring.pop( text, sizeof( text ) ) == -1 );
+   }
+
+   SECTION( "Wrap padding" )
+   {
+      CRecordRing ring( 64 );
+      char text[ 64 ];
+
+      REQUIRE( ring.push( "0123456789012345678", 20 ) );     // 24 bytes
+      REQUIRE( ring.push( "0123456789012345678", 20 ) );     // 48 bytes
+      REQUIRE( ring.pop( text, sizeof( text ) ) == 20 );
+      // 16 bytes at the end are not enough
+      REQUIRE( ring.push( "012345678901234567", 19 ) );
+      REQUIRE( ring.getUsed() == 24 + 16 + 24 );
+      REQUIRE( ring.push( "", 0 ) == false );
+
+      REQUIRE( ring.pop( text, sizeof( text ) ) == 20 );
+      // The padding is skipped
+      REQUIRE( ring.pop( text, 4 ) == 19 );
+      REQUIRE( strncmp( text, "0123", 4 ) == 0 );
+      REQUIRE( ring.getUsed() == 0 );
+   }
+
+   SECTION( "Threaded" )
+   {
+      CRecordRing ring( 256 );
+      const int RECORDS=100000;
+
+      std::thread producer( [&ring]()
+      {
+         unsigned char data[ 64 ];
+
+         for( int i1=0; i1<RECORDS; )
+         {
+            int size=i1 % 61;
+            memset( data, i1, size );
+            if( ring.push( data, size ) )
+            {
+               i1++;
+            }
+            else
+            {
+               std::this_thread::yield();
+            }
+         }
+      } );
+
+      bool valid=true;
+      for( int i1=0; i1<RECORDS; )
+      {
+         SRecord record=ring.peek();
+         if( !record.data )
+         {
+            std::this_thread::yield();
+            continue;
+         }
+         valid&=( record.size == i1 % 61 );
+         for( int i2=0; i2 < record.size; i2++ )
+         {
+            valid&=( ( (const unsigned char*)record.data )[i2] == (unsigned char)i1 );
+         }
+         ring.release();
+         i1++;
+      }
+      producer.join();
+      REQUIRE( valid );
+      REQUIRE( ring.isDataAvailable() == false );
+   }
+}
+
+
+/*--- Fin ------------------------------------------------------------------*/
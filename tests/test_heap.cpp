@@ -0,0 +1,154 @@
+/**---------------------------------------------------------------------------
+ *
+ * @file       test_heap.cpp
+ * @brief      Test the priority queues
+ *
+ * @date       20261017
+ * @author     Maximilian Seesslen <src@seesslen.net>
+ * @copyright  SPDX-License-Identifier: Apache-2.0
+ *
+ *--------------------------------------------------------------------------*/
+
+
+/*--- Includes -------------------------------------------------------------*/
+
+
+#if defined ( CATCH_V3 )
+   #include <catch2/catch_test_macros.hpp>
+#elif defined ( CATCH_V2 )
+   #include <catch2/catch.hpp>
+#elif defined ( CATCH_V1 )
+   #include <catch/catch.hpp>
+#else
+   #error "Either 'catch' or 'catch2' has to be installed"
+#endif
+
+#include <lepto/heap.hpp>
+
+
+/*--- Implementation -------------------------------------------------------*/
+
+
+struct STimer
+{
+   int deadline;
+   int id;
+
+   bool operator <( const STimer& other ) const
+   {
+      return( deadline < other.deadline );
+   }
+   bool operator ==( const STimer& other ) const
+   {
+      return( id == other.id );
+   }
+};
+
+struct SGreater
+{
+   bool operator()( int a, int b ) const
+   {
+      return( a > b );
+   }
+};
+
+template <typename H>
+static bool popsSorted( H& heap, int expected )
+{
+   int previous=0;
+   int value;
+   int popped=0;
+
+   while( heap.pop( value ) )
+   {
+      if( popped && ( value < previous ) )
+      {
+         return( false );
+      }
+      previous=value;
+      popped++;
+   }
+   return( popped == expected );
+}
+
+
+TEST_CASE( "Heap", "[default]" )
+{
+   SECTION( "Push and pop" )
+   {
+      CHeap<int> heap( 100 );
+      unsigned int random=1;
+      int value;
+
+      REQUIRE( heap.frontEntry() == nullptr );
+      REQUIRE( heap.pop( value ) == false );
+      for( int i1=0; i1<100; i1++ )
+      {
+         random=random * 1103515245 + 12345;
+         REQUIRE( heap.push( (int)( ( random >> 8 ) % 1000 ) ) );
+      }
+      REQUIRE( heap.isFull() );
+      REQUIRE( heap.push( 0 ) == false );
+      REQUIRE( popsSorted( heap, 100 ) );
+   }
+
+   SECTION( "Binary and custom order" )
+   {
+      CStaticHeap<int, 32, SGreater, 2> heap;
+      int value;
+
+      heap << 3 << 17 << -4 << 17 << 8;
+      REQUIRE( *heap.frontEntry() == 17 );
+      int expected[]={ 17, 17, 8, 3, -4 };
+      for( int entry: expected )
+      {
+         REQUIRE( heap.pop( value ) );
+         REQUIRE( value == entry );
+      }
+      REQUIRE( heap.isDataAvailable() == false );
+   }
+
+   SECTION( "Bulk" )
+   {
+      CStaticHeap<int, 64> heap;
+      int values[ 50 ];
+
+      for( int i1=0; i1<50; i1++ )
+      {
+         values[i1]=( i1 * 37 ) % 50;
+      }
+      // Rebuilt bottom up
+      heap << 25;
+      REQUIRE( heap.pushBulk( values, 50 ) == 50 );
+      // Sifted up one by one
+      REQUIRE( heap.pushBulk( values, 10 ) == 10 );
+      // Only what fits
+      REQUIRE( heap.pushBulk( values, 10 ) == 3 );
+      REQUIRE( popsSorted( heap, 64 ) );
+   }
+
+   SECTION( "Timers" )
+   {
+      CStaticHeap<STimer, 8> timers;
+      STimer timer;
+
+      timers.push( STimer{ 300, 1 } );
+      timers.push( STimer{ 100, 2 } );
+      timers.push( STimer{ 200, 3 } );
+      timers.push( STimer{ 150, 4 } );
+      REQUIRE( timers.frontEntry()->id == 2 );
+
+      // Cancel
+      REQUIRE( timers.remove( STimer{ 0, 4 } ) );
+      REQUIRE( timers.remove( STimer{ 0, 4 } ) == false );
+      timers.dropFront();
+      REQUIRE( timers.pop( timer ) );
+      REQUIRE( timer.id == 3 );
+      REQUIRE( timers.pop( timer ) );
+      REQUIRE( timer.id == 1 );
+      REQUIRE( timers.count() == 0 );
+   }
+}
+
+
+/*--- Fin ------------------------------------------------------------------*/
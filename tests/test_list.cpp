@@ -26,6 +26,8 @@
 #include <lepto/list.hpp>
 #include <lepto/ring.hpp>
 #include <list>
+#include <algorithm>
+#include <thread>
 // Optionally run the test on QList instead of CList
 #include <QList>
 
@@ -37,6 +39,83 @@
 /*--- Implementation -------------------------------------------------------*/
 
 
+// Owns heap memory like CString does; counts every allocation
+struct SPayload
+{
+   static int allocations;
+   int* data;
+
+   SPayload(): data(nullptr) {}
+   explicit SPayload( int value ): data( new int( value ) )
+   {
+      allocations++;
+   }
+   SPayload( const SPayload& r ): data(nullptr)
+   {
+      *this=r;
+   }
+   SPayload( SPayload&& r ): data( r.data )
+   {
+      r.data=nullptr;
+   }
+   ~SPayload()
+   {
+      delete data;
+   }
+   SPayload& operator=( const SPayload& r )
+   {
+      if( this != &r )
+      {
+         delete data;
+         data=r.data ? new int( *r.data ) : nullptr;
+         allocations+=( data != nullptr );
+      }
+      return( *this );
+   }
+   SPayload& operator=( SPayload&& r )
+   {
+      if( this != &r )
+      {
+         delete data;
+         data=r.data;
+         r.data=nullptr;
+      }
+      return( *this );
+   }
+};
+
+int SPayload::allocations=0;
+
+// Has no default constructor; counts living instances
+struct SAlive
+{
+   static int alive;
+   int value;
+
+   explicit SAlive( int v ): value( v )
+   {
+      alive++;
+   }
+   SAlive( const SAlive& r ): value( r.value )
+   {
+      alive++;
+   }
+   SAlive& operator=( const SAlive& r ) = default;
+   ~SAlive()
+   {
+      alive--;
+   }
+};
+
+int SAlive::alive=0;
+
+// Comparison for CList::find()
+static bool operator <( CList<int>::CIterator iterator, int value )
+{
+   return( *iterator < value );
+}
+
+
 TEST_CASE( "List", "[default]" )
 {
    SECTION( "Volatile" )
@@ -233,6 +312,105 @@ TEST_CASE( "List", "[default]" )
       #endif
    }
    
+   SECTION( "Aggregation" )
+   {
+      CRing<unsigned char> bytes( 300 );
+
+      REQUIRE( bytes.sum() == 0 );
+      REQUIRE( bytes.mean() == 0 );
+      REQUIRE( bytes.min() == 0 );
+
+      // Wrap the content
+      for( int i1=0; i1<150; i1++ )
+      {
+         bytes << 1;
+      }
+      for( int i1=0; i1<150; i1++ )
+      {
+         bytes.dropFront();
+      }
+      for( int i1=0; i1<250; i1++ )
+      {
+         bytes << (unsigned char)( 200 + ( i1 % 3 ) );
+      }
+      REQUIRE( bytes.readableSpans().second.size > 0 );
+
+      // Would overflow when summing up as unsigned char
+      REQUIRE( bytes.sum() == 250 * 200 + 83 * 1 + 83 * 2 );
+      REQUIRE( bytes.average() == 200 );
+      REQUIRE( bytes.min() == 200 );
+      REQUIRE( bytes.max() == 202 );
+
+      CList<int> ints( 8 );
+      ints << -5 << 7 << 3;
+      REQUIRE( ints.sum() == 5 );
+      REQUIRE( ints.mean() == 1 );
+      REQUIRE( ints.min() == -5 );
+      REQUIRE( ints.max() == 7 );
+   }
+
+   SECTION( "Sorted" )
+   {
+      CList<int> list( 64 );
+
+      REQUIRE( list.lower_bound( 5 ) == 0 );
+      REQUIRE( list.upper_bound( 5 ) == 0 );
+      REQUIRE( list.find( 5 ) == list.end() );
+
+      // Wrap the content; 0, 2, 2, 4, 6, ..., 84
+      for( int i1=0; i1<40; i1++ )
+      {
+         list << 0;
+         list.dropFront();
+      }
+      for( int i1=0; i1<=42; i1++ )
+      {
+         list << i1 * 2;
+         if( i1 == 1 )
+         {
+            list << 2;
+         }
+      }
+      REQUIRE( list.readableSpans().second.size > 0 );
+
+      for( int value=-1; value<=86; value++ )
+      {
+         int lower=0;
+         int upper=0;
+         for( int i1=0; i1<list.count(); i1++ )
+         {
+            lower+=( *list.getEntry( i1 ) < value );
+            upper+=( *list.getEntry( i1 ) <= value );
+         }
+         REQUIRE( list.lower_bound( value ) == lower );
+         REQUIRE( list.upper_bound( value ) == upper );
+         REQUIRE( list.find( value ) == list.at( lower ) );
+      }
+      REQUIRE( list.equal_range( 2 ).first == 1 );
+      REQUIRE( list.equal_range( 2 ).size() == 2 );
+      REQUIRE( list.equal_range( 3 ).size() == 0 );
+
+      // Sorted insertion across the wrap point
+      CList<int> sorted( 16 );
+      for( int i1=0; i1<10; i1++ )
+      {
+         sorted << 0;
+         sorted.dropFront();
+      }
+      int values[]={ 7, 3, 9, 3, 1, 12, 0, 5 };
+      for( int value: values )
+      {
+         REQUIRE( sorted.insertSorted( value ) );
+      }
+      REQUIRE( sorted.readableSpans().second.size > 0 );
+      int expected[]={ 0, 1, 3, 3, 5, 7, 9, 12 };
+      REQUIRE( sorted.count() == 8 );
+      for( int i1=0; i1<8; i1++ )
+      {
+         REQUIRE( *sorted.getEntry( i1 ) == expected[ i1 ] );
+      }
+   }
+
    SECTION( "Iterator" )
    {
       CList<int> liste(10);
@@ -242,6 +420,255 @@ TEST_CASE( "List", "[default]" )
       REQUIRE( iterator.realIndex() == 1 );
    }
    
+   SECTION( "Random access iterator" )
+   {
+      CList<int> list( 16 );
+
+      // Wrap the content; 9 8 7 6 5 4 3 2 1 0
+      for( int i1=0; i1<12; i1++ )
+      {
+         list << 0;
+         list.dropFront();
+      }
+      for( int i1=9; i1>=0; i1-- )
+      {
+         list << i1;
+      }
+      REQUIRE( list.segments().second.size > 0 );
+      REQUIRE( list.end() - list.begin() == 10 );
+      REQUIRE( list.begin()[ 3 ] == 6 );
+      REQUIRE( *( list.end() - 1 ) == 0 );
+      REQUIRE( list.begin() < list.end() );
+      REQUIRE( list.begin() + 10 == list.end() );
+      REQUIRE( list.at( 7 ) - list.at( 2 ) == 5 );
+
+      CList<int>::CIterator iterator=list.end();
+      iterator--;
+      --iterator;
+      REQUIRE( *iterator-- == 1 );
+      REQUIRE( *iterator == 2 );
+      iterator+=-5;
+      REQUIRE( *iterator == 7 );
+      REQUIRE( iterator.realIndex() == list.at( 2 ).realIndex() );
+
+      std::sort( list.begin(), list.end() );
+      for( int i1=0; i1<10; i1++ )
+      {
+         REQUIRE( *list.getEntry( i1 ) == i1 );
+      }
+      REQUIRE( std::lower_bound( list.begin(), list.end(), 4 ) - list.begin() == 4 );
+
+      const CList<int>& constList=list;
+      CList<int>::const_iterator constIterator=list.begin();
+      REQUIRE( constIterator == constList.begin() );
+      REQUIRE( std::count_if( constList.begin(), constList.end(),
+                              []( int value ) { return( value & 1 ); } ) == 5 );
+
+      // Copy out through the contiguous segments
+      int copy[ 10 ];
+      CList<int>::SSpans segments=list.segments();
+      memcpy( copy, segments.first.data, segments.first.size * sizeof( int ) );
+      memcpy( copy + segments.first.size, segments.second.data,
+              segments.second.size * sizeof( int ) );
+      REQUIRE( segments.size() == 10 );
+      REQUIRE( std::equal( list.cbegin(), list.cend(), copy ) );
+   }
+
+   SECTION( "Bulk" )
+   {
+      CRing<char> ring( 8 + LEPTO_RING_SPARE_ENTRIES );
+      char buffer[ 16 ];
+
+      REQUIRE( ring.pushBulk( "abcde", 5 ) == 5 );
+      REQUIRE( ring.popBulk( buffer, 3 ) == 3 );
+      REQUIRE( memcmp( buffer, "abc", 3 ) == 0 );
+
+      // Crosses the wrap point; only 6 entries are free
+      REQUIRE( ring.pushBulk( "fghijklmn", 9 ) == 6 );
+      REQUIRE( ring.count() == 8 );
+      REQUIRE( ring.pushBulk( "x", 1 ) == 0 );
+      REQUIRE( ring.popBulk( buffer, -1 ) == 0 );
+      REQUIRE( ring.count() == 8 );
+
+      CRing<char>::SSpans spans=ring.readableSpans();
+      REQUIRE( spans.size() == 8 );
+      REQUIRE( spans.second.size > 0 );
+      REQUIRE( spans.first.data[0] == 'd' );
+      REQUIRE( spans.second.data[ spans.second.size - 1 ] == 'k' );
+      ring.commit( 2 );
+      REQUIRE( *ring.frontEntry() == 'f' );
+
+      REQUIRE( ring.popBulk( buffer, sizeof(buffer) ) == 6 );
+      REQUIRE( memcmp( buffer, "fghijk", 6 ) == 0 );
+      REQUIRE( ring.isDataAvailable() == false );
+      REQUIRE( ring.readableSpans().size() == 0 );
+   }
+
+   #if IS_ENABLED( CONFIG_LEPTO_LIST_RESIZABLE )
+   SECTION( "Growth" )
+   {
+      CList<int> list( 4 );
+
+      // Wrap the content before expanding
+      list << 100 << 101;
+      list.dropFront();
+      list.dropFront();
+
+      for( int i1=0; i1<100000; i1++ )
+      {
+         REQUIRE( list.push_back( i1 ) == true );
+      }
+      REQUIRE( list.count() == 100000 );
+      // Doubling; 4, 12, 24, ...
+      REQUIRE( list.getMaxEntries() == 12 << 14 );
+      for( int i1=0; i1<100000; i1++ )
+      {
+         REQUIRE( list.pop() == i1 );
+      }
+
+      CList<int> linear( 4 );
+      linear.setGrowth( EListGrowth::Linear );
+      for( int i1=0; i1<5; i1++ )
+      {
+         linear << i1;
+      }
+      REQUIRE( linear.getMaxEntries() == 4 + CONFIG_LEPTO_LIST_INCREMENT );
+   }
+
+   SECTION( "Growth with concurrent producers" )
+   {
+      static constexpr int PRODUCERS = 4;
+      static constexpr int LOOPS = 20000;
+      CList<int> list( 4 );
+      std::thread producers[ PRODUCERS ];
+      int last[ PRODUCERS + 1 ];
+      int errors=0;
+
+      last[ PRODUCERS ]=-1;
+      for( int i1=0; i1<PRODUCERS; i1++ )
+      {
+         last[i1]=-1;
+         producers[i1]=std::thread( [&list, i1]()
+         {
+            for( int i2=0; i2<LOOPS; i2++ )
+            {
+               list.push_back( i1 * LOOPS + i2 );
+            }
+         } );
+      }
+      // Bulk producer; refused while the list is being expanded
+      std::thread bulk( [&list]()
+      {
+         for( int i2=0; i2<LOOPS; )
+         {
+            int values[ 3 ]={ PRODUCERS * LOOPS + i2, PRODUCERS * LOOPS + i2 + 1,
+                              PRODUCERS * LOOPS + i2 + 2 };
+            int pushed=list.pushBulk( values, MIN( 3, LOOPS - i2 ) );
+            if( ! pushed )
+            {
+               // Full or expanding; grow like push_back() does
+               if( list.push_back( values[0] ) )
+               {
+                  pushed=1;
+               }
+            }
+            i2+=pushed;
+         }
+      } );
+      for( int i1=0; i1<PRODUCERS; i1++ )
+      {
+         producers[i1].join();
+      }
+      bulk.join();
+
+      REQUIRE( list.count() == ( PRODUCERS + 1 ) * LOOPS );
+      while( list.isDataAvailable() )
+      {
+         int value=list.pop();
+         int producer=value / LOOPS;
+         if( value % LOOPS != last[ producer ] + 1 )
+         {
+            errors++;
+         }
+         last[ producer ]=value % LOOPS;
+      }
+      REQUIRE( errors == 0 );
+   }
+   #endif
+
+   SECTION( "Move" )
+   {
+      CList<SPayload> list( 4 );
+      SPayload popped;
+      int pushed=3;
+
+      SPayload::allocations=0;
+      REQUIRE( list.emplace_back( 0 ) == true );
+      REQUIRE( list.push_back( SPayload( 1 ) ) == true );
+      SPayload payload( 2 );
+      REQUIRE( list.push_back( doMove( payload ) ) == true );
+      REQUIRE( payload.data == nullptr );
+      REQUIRE( SPayload::allocations == 3 );
+
+      #if IS_ENABLED( CONFIG_LEPTO_LIST_RESIZABLE )
+         // Expanding moves the entries to the new buffer
+         for( ; pushed<20; pushed++ )
+         {
+            REQUIRE( list.emplace_back( pushed ) == true );
+         }
+         REQUIRE( list.getMaxEntries() > 4 );
+         REQUIRE( SPayload::allocations == pushed );
+      #endif
+
+      for( int i1=0; i1<pushed; i1++ )
+      {
+         REQUIRE( list.pop( popped ) == true );
+         REQUIRE( *popped.data == i1 );
+      }
+      REQUIRE( list.pop( popped ) == false );
+      REQUIRE( SPayload::allocations == pushed );
+
+      // Copying still copies
+      SPayload copied( 42 );
+      list << copied;
+      REQUIRE( SPayload::allocations == pushed + 2 );
+      REQUIRE( *copied.data == 42 );
+   }
+
+   SECTION( "Uninitialized storage" )
+   {
+      SAlive::alive=0;
+      {
+         CList<SAlive> list( 100000 );
+         REQUIRE( SAlive::alive == 0 );
+
+         list.emplace_back( 1 );
+         list.push_back( SAlive( 2 ) );
+         list << SAlive( 3 ) << SAlive( 4 );
+         REQUIRE( SAlive::alive == 4 );
+         REQUIRE( list.frontEntry()->value == 1 );
+
+         list.dropFront();
+         REQUIRE( SAlive::alive == 3 );
+
+         SAlive popped( 0 );
+         REQUIRE( list.pop( popped ) == true );
+         REQUIRE( popped.value == 2 );
+         REQUIRE( SAlive::alive == 3 );
+
+         list.clear();
+         REQUIRE( SAlive::alive == 1 );
+
+         SAlive bulk[3]={ SAlive( 5 ), SAlive( 6 ), SAlive( 7 ) };
+         REQUIRE( list.pushBulk( bulk, 3 ) == 3 );
+         REQUIRE( SAlive::alive == 7 );
+         list.commit( 2 );
+         REQUIRE( SAlive::alive == 5 );
+      }
+      // The destructor destroys the remaining entry
+      REQUIRE( SAlive::alive == 0 );
+   }
+
    SECTION( "C++ iterate" )
    {
       CList<int> list(0);
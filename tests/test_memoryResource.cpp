@@ -0,0 +1,147 @@
+/**---------------------------------------------------------------------------
+ *
+ * @file       test_memoryResource.cpp
+ * @brief      Test the memory resources with lists and rings
+ *
+ * @date       20261017
+ * @author     Maximilian Seesslen <src@seesslen.net>
+ * @copyright  SPDX-License-Identifier: Apache-2.0
+ *
+ *--------------------------------------------------------------------------*/
+
+
+/*--- Includes -------------------------------------------------------------*/
+
+
+#if defined ( CATCH_V3 )
+   #include <catch2/catch_test_macros.hpp>
+#elif defined ( CATCH_V2 )
+   #include <catch2/catch.hpp>
+#elif defined ( CATCH_V1 )
+   #include <catch/catch.hpp>
+#else
+   #error "Either 'catch' or 'catch2' has to be installed"
+#endif
+
+#include <lepto/memoryResource.hpp>
+#include <lepto/ring.hpp>
+#include <lepto/bufferRing.hpp>
+#include <string.h>
+
+
+/*--- Implementation -------------------------------------------------------*/
+
+
+TEST_CASE( "Memory resource", "[default]" )
+{
+   SECTION( "Static buffer" )
+   {
+      alignas( 16 ) static char storage[ 256 ];
+      CStaticBufferResource resource( storage, sizeof( storage ) );
+
+      {
+         CRing<int> ring( 16, &resource );
+         REQUIRE( resource.getUsed() == 16 * sizeof( int ) );
+         REQUIRE( ring.getBuffers() == (int*)storage );
+
+         for( int i1=0; i1<10; i1++ )
+         {
+            ring << i1;
+         }
+         for( int i1=0; i1<10; i1++ )
+         {
+            REQUIRE( ring.pop() == i1 );
+         }
+      }
+      // The top allocation is given back
+      REQUIRE( resource.getUsed() == 0 );
+
+      CRing<char> small( 3, &resource );
+      CRing<double> aligned( 8, &resource );
+      REQUIRE( ( (uintptr_t)aligned.getBuffers() % alignof( double ) ) == 0 );
+      REQUIRE( resource.allocate( 256, 1 ) == nullptr );
+
+      #if IS_ENABLED( CONFIG_LEPTO_LIST_RESIZABLE )
+         // Expanding fails gracefully when the buffer is exhausted
+         for( int i1=0; i1<20; i1++ )
+         {
+            aligned.push_back( i1 );
+         }
+         REQUIRE( aligned.count() > 0 );
+         REQUIRE( aligned.pop() == 0.0 );
+      #endif
+   }
+
+   SECTION( "Monotonic" )
+   {
+      CMonotonicResource resource( 4096 );
+      char* previous=nullptr;
+
+      for( int i1=0; i1<8; i1++ )
+      {
+         CList<int>* list=new CList<int>( 32, &resource );
+         list->push_back( i1 );
+         REQUIRE( list->pop() == i1 );
+         // Consecutive rings are packed into the first chunk
+         if( previous )
+         {
+            REQUIRE( (char*)list->getBuffers() == previous + 32 * sizeof( int ) );
+         }
+         previous=(char*)list->getBuffers();
+         delete list;
+      }
+
+      // Bigger than a chunk
+      CRing<int> big( 1000, &resource );
+      big << 42;
+      REQUIRE( big.pop() == 42 );
+
+      char initial[ 128 ];
+      CMonotonicResource withBuffer( initial, sizeof( initial ) );
+      CRing<char> ring( 64, &withBuffer );
+      REQUIRE( ring.getBuffers() == initial );
+   }
+
+   #if defined( __linux__ )
+   SECTION( "Huge pages" )
+   {
+      CHugePageResource resource;
+
+      {
+         CRing<int> ring( 1024, &resource );
+         for( int i1=0; i1<2000; i1++ )
+         {
+            ring.push_back( i1 );
+            REQUIRE( ring.pop() == i1 );
+         }
+         REQUIRE( ( (uintptr_t)ring.getBuffers() % 4096 ) == 0 );
+      }
+      REQUIRE( resource.getHugeMappings() + resource.getFallbackMappings() == 1 );
+
+      // Aligned to the huge pages, with or without reserved huge pages
+      void* p=resource.allocate( 100, 2 * 1024 * 1024 );
+      REQUIRE( p != nullptr );
+      REQUIRE( ( (uintptr_t)p % ( 2 * 1024 * 1024 ) ) == 0 );
+      memset( p, 0x55, 100 );
+      resource.deallocate( p, 100, 2 * 1024 * 1024 );
+   }
+   #endif
+
+   SECTION( "Buffer ring" )
+   {
+      alignas( 16 ) static char storage[ 1024 ];
+      CStaticBufferResource resource( storage, sizeof( storage ) );
+      CBufferRing ring( 64, 4, &resource );
+
+      REQUIRE( resource.getUsed() >= 4 * 64 + 4 * sizeof( SBuffer ) );
+      void* data=ring.pushBuffer( 10 );
+      REQUIRE( data != nullptr );
+      REQUIRE( (char*)data >= storage );
+      REQUIRE( (char*)data < storage + sizeof( storage ) );
+      REQUIRE( ring.getBottomData() == data );
+      ring.dropBuffer();
+   }
+}
+
+
+/*--- Fin ------------------------------------------------------------------*/
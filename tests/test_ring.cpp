@@ -26,6 +26,17 @@
 #endif
 
 #include <lepto/ring.hpp>
+#include <lepto/ringPow2.hpp>
+#include <lepto/staticRing.hpp>
+#include <lepto/ringSpsc.hpp>
+#include <lepto/waitableRing.hpp>
+#include <lepto/segmentedRing.hpp>
+#include <lepto/statsRing.hpp>
+#include <lepto/lossyRing.hpp>
+#include <lepto/broadcastRing.hpp>
+#include <thread>
+#include <chrono>
+#include <type_traits>
 
 //--- Own ----------------------------
 
@@ -42,4 +53,800 @@ TEST_CASE( "Ring", "[default]" )
 }
 
 
+TEST_CASE( "Ring power of two", "[default]" )
+{
+   SECTION( "Push and pop" )
+   {
+      CRingPow2<int, 4> ring;
+
+      REQUIRE( ring.frontEntry() == nullptr );
+      REQUIRE( ring.getMaxEntries() == 4 );
+      for( int i1=0; i1<4; i1++ )
+      {
+         REQUIRE( ring.push_back( i1 + 1 ) == true );
+      }
+      REQUIRE( ring.pushable() == false );
+      #if ! IS_ENABLED( CONFIG_LEPTO_LIST_ABORT_FAILING_PUSH )
+      REQUIRE( ring.push_back( 5 ) == false );
+      #endif
+      REQUIRE( ring.count() == 4 );
+      REQUIRE( *ring.getEntry( 3 ) == 4 );
+      REQUIRE( ring.getEntry( 4 ) == nullptr );
+      REQUIRE( ring.pop() == 1 );
+      REQUIRE( ring.pop() == 2 );
+      REQUIRE( ring.count() == 2 );
+   }
+
+   SECTION( "Overflow of free running index" )
+   {
+      CRingPow2<int, 8> ring;
+      ringIndex_t index;
+
+      // Let the indices overflow
+      ring.setFrontBack( (ringIndex_t)-3, (ringIndex_t)-3 );
+      for( int i1=0; i1<8; i1++ )
+      {
+         REQUIRE( ring.push_back( i1 ) == true );
+      }
+      REQUIRE( ring.isFull() );
+      REQUIRE( ring.count() == 8 );
+      for( int i1=0; i1<8; i1++ )
+      {
+         REQUIRE( ring.pop() == i1 );
+      }
+      REQUIRE( ring.count() == 0 );
+
+      REQUIRE( ( index = ring.tryReserve() ) != (ringIndex_t)-1 );
+      *ring.reservedEntry( index ) = 0x42;
+      ring.pushReserved( index );
+      REQUIRE( ring.isDataAvailable() );
+      REQUIRE( *ring.frontEntry() == 0x42 );
+   }
+
+   SECTION( "Volatile" )
+   {
+      CRingPow2<int, 4> ring;
+      ring.setVolatile( true );
+
+      for( int i1=0; i1<10; i1++ )
+      {
+         ring << i1;
+      }
+      REQUIRE( ring.count() == 4 );
+      REQUIRE( ring.pop() == 6 );
+   }
+}
+
+
+// Has to be constant initialized; no constructor runs at startup
+static constexpr CStaticRing<int, 4> constRing;
+static_assert( constRing.getMaxEntries() == 4, "CStaticRing is not constexpr" );
+static CStaticRing<int, 24> staticRing;
+
+
+TEST_CASE( "Static ring", "[default]" )
+{
+   SECTION( "Push and pop" )
+   {
+      REQUIRE( staticRing.frontEntry() == nullptr );
+      REQUIRE( staticRing.getMaxEntries() == 24 );
+      REQUIRE( sizeof( CStaticRing<int, 24> ) >= 24 * sizeof( int ) );
+
+      // Cross the wrap of the index range [0, 2*N) several times
+      for( int i1=0; i1<100; i1++ )
+      {
+         REQUIRE( staticRing.push_back( i1 ) == true );
+         REQUIRE( staticRing.push_back( i1 + 1 ) == true );
+         REQUIRE( staticRing.count() == 2 );
+         REQUIRE( *staticRing.getEntry( 1 ) == i1 + 1 );
+         REQUIRE( staticRing.pop() == i1 );
+         REQUIRE( staticRing.pop() == i1 + 1 );
+      }
+      REQUIRE( staticRing.isDataAvailable() == false );
+   }
+
+   SECTION( "Full" )
+   {
+      CStaticRing<int, 5> ring;
+      ringIndex_t index;
+
+      ring.setFrontBack( 8, 8 );
+      for( int i1=0; i1<5; i1++ )
+      {
+         REQUIRE( ( index = ring.tryReserve() ) != (ringIndex_t)-1 );
+         *ring.reservedEntry( index ) = i1;
+         ring.pushReserved( index );
+      }
+      REQUIRE( ring.isFull() );
+      REQUIRE( ring.count() == 5 );
+      REQUIRE( ring.tryReserve() == (ringIndex_t)-1 );
+      REQUIRE( ring.backEntry() == nullptr );
+      for( int i1=0; i1<5; i1++ )
+      {
+         REQUIRE( *ring.frontEntry() == i1 );
+         ring.dropFront();
+      }
+      REQUIRE( ring.count() == 0 );
+   }
+
+   SECTION( "Power of two" )
+   {
+      CStaticRing<int, 4> ring;
+
+      ring.setFrontBack( (ringIndex_t)-2, (ringIndex_t)-2 );
+      for( int i1=0; i1<4; i1++ )
+      {
+         ring << i1;
+      }
+      REQUIRE( ring.isFull() );
+      REQUIRE( ring.pop() == 0 );
+      REQUIRE( ring.count() == 3 );
+   }
+}
+
+
+TEST_CASE( "Ring SPSC", "[default]" )
+{
+   SECTION( "Push and pop" )
+   {
+      CSpscRing<int> ring( 3 );
+
+      REQUIRE( ring.frontEntry() == nullptr );
+      for( int i1=0; i1<20; i1++ )
+      {
+         REQUIRE( ring.push_back( i1 ) == true );
+         REQUIRE( ring.push_back( i1 + 1 ) == true );
+         REQUIRE( ring.push_back( i1 + 2 ) == true );
+         REQUIRE( ring.isFull() );
+         REQUIRE( ring.push_back( 0 ) == false );
+         REQUIRE( ring.backEntry() == nullptr );
+         REQUIRE( ring.count() == 3 );
+         REQUIRE( ring.pop() == i1 );
+         REQUIRE( *ring.frontEntry() == i1 + 1 );
+         ring.dropFront();
+         REQUIRE( ring.pop() == i1 + 2 );
+         REQUIRE( ring.isDataAvailable() == false );
+      }
+   }
+
+   SECTION( "Threaded" )
+   {
+      static constexpr int LOOPS = 200000;
+      CSpscRing<int> ring( 16 );
+      int errors=0;
+
+      std::thread producer( [&ring]()
+      {
+         for( int i1=0; i1 < LOOPS; )
+         {
+            if( ring.push_back( i1 ) )
+            {
+               i1++;
+            }
+            else
+            {
+               std::this_thread::yield();
+            }
+         }
+      } );
+
+      for( int i1=0; i1 < LOOPS; )
+      {
+         int* entry=ring.frontEntry();
+         if( !entry )
+         {
+            std::this_thread::yield();
+            continue;
+         }
+         if( *entry != i1 )
+         {
+            errors++;
+         }
+         ring.dropFront();
+         i1++;
+      }
+      producer.join();
+
+      REQUIRE( errors == 0 );
+      REQUIRE( ring.count() == 0 );
+   }
+}
+
+
+TEST_CASE( "Waitable ring", "[default]" )
+{
+   SECTION( "Timeout" )
+   {
+      CWaitableRing<int> ring( 2 );
+
+      long long start=leptoMonotonicMs();
+      REQUIRE( ring.waitForData( 50 ) == false );
+      REQUIRE( leptoMonotonicMs() - start >= 45 );
+      REQUIRE( ring.waitForSpace( 0 ) == true );
+
+      ring << 1 << 2;
+      REQUIRE( ring.waitForSpace( 10 ) == false );
+      REQUIRE( ring.waitForData( 0 ) == true );
+   }
+
+   SECTION( "Wake up" )
+   {
+      static constexpr int LOOPS = 10000;
+      CWaitableRing<int> ring( 4 );
+      long long sum=0;
+
+      #if IS_ENABLED( CONFIG_LEPTO_LIST_RESIZABLE )
+         // Expanding is not allowed while the consumer is active
+         ring.setResizable( false );
+      #endif
+
+      std::thread producer( [&ring]()
+      {
+         // Let the consumer park first
+         std::this_thread::sleep_for( std::chrono::milliseconds( 20 ) );
+         for( int i1=0; i1 < LOOPS; i1++ )
+         {
+            while( ! ring.push_back( i1 ) )
+            {
+               ring.waitForSpace();
+            }
+         }
+      } );
+
+      for( int i1=0; i1 < LOOPS; i1++ )
+      {
+         REQUIRE( ring.waitForData( 5000 ) == true );
+         sum += ring.pop();
+      }
+      producer.join();
+
+      REQUIRE( sum == (long long)LOOPS * ( LOOPS - 1 ) / 2 );
+   }
+}
+
+
+/**
+ * @brief Plays the producer that loses the race for linking a segment
+ */
+class CSegmentedRingRace: public CSegmentedRing<int, 1>
+{
+   public:
+      void loseLinkRace()
+      {
+         auto tail=getTail();
+
+         // Winner links its segment but did not move m_tail yet
+         linkSegment( tail, takeSegment() );
+         // Loser
+         linkSegment( tail, takeSegment() );
+      }
+
+      /**
+       * @brief A producer gets busy after the consumer took the spares. It
+       *        may hold a spare as free list head already.
+       * @return true if the free list hands out a spare meanwhile
+       */
+      bool recycleWhileProducing()
+      {
+         auto spare=takeSpares();
+
+         enterProducer();
+         recycleSegments( spare );
+         auto segment=takeSegment();
+         // Back to the spares; the tail is linked already
+         linkSegment( getTail(), segment );
+         leaveProducer();
+
+         return( segment == spare );
+      }
+};
+
+
+TEST_CASE( "Segmented ring", "[default]" )
+{
+   SECTION( "Grow and recycle" )
+   {
+      CSegmentedRing<int, 4> ring;
+      int value;
+
+      REQUIRE( ring.pop( value ) == false );
+      for( int i1=0; i1<10; i1++ )
+      {
+         ring << i1;
+      }
+      // 3 segments in the chain, one spare appended
+      REQUIRE( ring.getAllocatedSegments() == 3 );
+      for( int i1=0; i1<10; i1++ )
+      {
+         REQUIRE( ring.pop( value ) == true );
+         REQUIRE( value == i1 );
+      }
+      REQUIRE( ring.pop( value ) == false );
+
+      // Steady state; segments come from the free list
+      int allocated=ring.getAllocatedSegments();
+      for( int i1=0; i1<1000; i1++ )
+      {
+         ring << i1 << i1 + 1 << i1 + 2;
+         REQUIRE( *ring.frontEntry() == i1 );
+         ring.dropFront();
+         REQUIRE( ring.pop( value ) == true );
+         REQUIRE( value == i1 + 1 );
+         REQUIRE( ring.pop( value ) == true );
+         REQUIRE( value == i1 + 2 );
+         REQUIRE( ring.isDataAvailable() == false );
+      }
+      REQUIRE( ring.getAllocatedSegments() == allocated );
+   }
+
+   SECTION( "Threaded" )
+   {
+      static constexpr int PRODUCERS = 4;
+      static constexpr int LOOPS = 50000;
+      CSegmentedRing<int, 16> ring;
+      std::thread producers[ PRODUCERS ];
+      int last[ PRODUCERS ];
+      int errors=0;
+
+      for( int i1=0; i1 < PRODUCERS; i1++ )
+      {
+         last[i1]=-1;
+         producers[i1]=std::thread( [&ring, i1]()
+         {
+            for( int i2=0; i2 < LOOPS; i2++ )
+            {
+               ring.push_back( ( i1 << 24 ) | i2 );
+            }
+         } );
+      }
+
+      for( int i1=0; i1 < PRODUCERS * LOOPS; )
+      {
+         int value;
+         if( ! ring.pop( value ) )
+         {
+            std::this_thread::yield();
+            continue;
+         }
+         // Entries of one producer have to arrive in order
+         int producer=value >> 24;
+         int sequence=value & 0xFFFFFF;
+         if( sequence != last[ producer ] + 1 )
+         {
+            errors++;
+         }
+         last[ producer ]=sequence;
+         i1++;
+      }
+      for( int i1=0; i1 < PRODUCERS; i1++ )
+      {
+         producers[i1].join();
+      }
+
+      int value;
+      REQUIRE( errors == 0 );
+      REQUIRE( ring.pop( value ) == false );
+   }
+
+   SECTION( "Failed append" )
+   {
+      CSegmentedRingRace ring;
+      int value;
+
+      ring << 1;
+      ring.loseLinkRace();
+
+      // Full drain; the consumed tail segment must not be recycled
+      REQUIRE( ring.pop( value ) == true );
+      REQUIRE( value == 1 );
+      REQUIRE( ring.pop( value ) == false );
+
+      for( int i1=0; i1<4; i1++ )
+      {
+         ring << 10 + i1;
+         REQUIRE( ring.pop( value ) == true );
+         REQUIRE( value == 10 + i1 );
+         REQUIRE( ring.pop( value ) == false );
+      }
+      // Spare came back via the free list
+      REQUIRE( ring.getAllocatedSegments() == 3 );
+   }
+
+   SECTION( "Producer busy while recycling" )
+   {
+      CSegmentedRingRace ring;
+      int value;
+
+      ring << 1;
+      ring.loseLinkRace();
+
+      // The spare must not go to the free list; a new segment is allocated
+      REQUIRE( ring.recycleWhileProducing() == false );
+      REQUIRE( ring.getAllocatedSegments() == 4 );
+
+      REQUIRE( ring.pop( value ) == true );
+      REQUIRE( value == 1 );
+      for( int i1=0; i1<4; i1++ )
+      {
+         ring << 10 + i1;
+         REQUIRE( ring.pop( value ) == true );
+         REQUIRE( value == 10 + i1 );
+      }
+      // Both spares came back via the free list
+      REQUIRE( ring.getAllocatedSegments() == 4 );
+   }
+
+   SECTION( "Lost append race" )
+   {
+      // One entry per segment; producers race for appending all the time
+      static constexpr int PRODUCERS = 4;
+      static constexpr int LOOPS = 100;
+      CSegmentedRing<int, 1> ring;
+      int lost=0;
+
+      for( int round=0; round < 200; round++ )
+      {
+         std::thread producers[ PRODUCERS ];
+         int value;
+
+         for( int i1=0; i1 < PRODUCERS; i1++ )
+         {
+            producers[i1]=std::thread( [&ring]()
+            {
+               for( int i2=0; i2 < LOOPS; i2++ )
+               {
+                  ring.push_back( i2 );
+               }
+            } );
+         }
+         for( int i1=0; i1 < PRODUCERS; i1++ )
+         {
+            producers[i1].join();
+         }
+
+         // Full drain; recycles the segments behind
+         int popped=0;
+         while( ring.pop( value ) )
+         {
+            popped++;
+         }
+         lost+=PRODUCERS * LOOPS - popped;
+
+         // The tail must not be on the free list now
+         ring << -1;
+         if( ! ring.pop( value ) || ( value != -1 ) )
+         {
+            lost++;
+         }
+      }
+      REQUIRE( lost == 0 );
+   }
+}
+
+
+TEST_CASE( "Lossy ring", "[default]" )
+{
+   SECTION( "Overwrite oldest" )
+   {
+      CLossyRing<int> ring( 8 );
+      int value;
+
+      REQUIRE( ring.pop( value ) == false );
+      for( int i1=0; i1<5; i1++ )
+      {
+         ring << i1;
+      }
+      REQUIRE( ring.count() == 5 );
+      REQUIRE( ring.pop( value ) == true );
+      REQUIRE( value == 0 );
+
+      // 1..4 are still there; 1..6 get overwritten
+      for( int i1=5; i1<15; i1++ )
+      {
+         REQUIRE( ring.push_back( i1 ) == true );
+      }
+      REQUIRE( ring.count() == 8 );
+      for( int i1=7; i1<15; i1++ )
+      {
+         REQUIRE( ring.pop( value ) == true );
+         REQUIRE( value == i1 );
+      }
+      REQUIRE( ring.pop( value ) == false );
+      REQUIRE( ring.getDropped() == 6 );
+   }
+
+   SECTION( "Concurrent producers" )
+   {
+      struct SSample
+      {
+         int producer;
+         int sequence;
+         int check;
+      };
+      static constexpr int PRODUCERS = 4;
+      static constexpr int LOOPS = 100000;
+      CLossyRing<SSample> ring( 64 );
+      std::thread producers[ PRODUCERS ];
+      int last[ PRODUCERS ];
+      int done=0;
+      int popped=0;
+      int errors=0;
+
+      for( int i1=0; i1 < PRODUCERS; i1++ )
+      {
+         last[i1]=-1;
+         producers[i1]=std::thread( [&ring, &done, i1]()
+         {
+            for( int i2=0; i2 < LOOPS; i2++ )
+            {
+               ring.push_back( SSample{ i1, i2, ~( i1 ^ i2 ) } );
+            }
+            __atomic_add_fetch( &done, 1, __ATOMIC_SEQ_CST );
+         } );
+      }
+
+      SSample sample;
+      while( true )
+      {
+         bool finished=( __atomic_load_n( &done, __ATOMIC_SEQ_CST ) == PRODUCERS );
+         if( ! ring.pop( sample ) )
+         {
+            if( finished )
+            {
+               break;
+            }
+            continue;
+         }
+         // No torn entries; entries of one producer still in order
+         if( ( sample.check != ~( sample.producer ^ sample.sequence ) )
+             || ( sample.sequence <= last[ sample.producer ] ) )
+         {
+            errors++;
+         }
+         last[ sample.producer ]=sample.sequence;
+         popped++;
+      }
+      for( int i1=0; i1 < PRODUCERS; i1++ )
+      {
+         producers[i1].join();
+      }
+
+      REQUIRE( errors == 0 );
+      REQUIRE( popped > 0 );
+      REQUIRE( popped + ring.getDropped() == PRODUCERS * LOOPS );
+   }
+}
+
+
+TEST_CASE( "Broadcast ring", "[default]" )
+{
+   SECTION( "Slowest reader blocks" )
+   {
+      CBroadcastRing<int> ring( 4, 2 );
+      CBroadcastRing<int>::CReader fast( ring );
+      CBroadcastRing<int>::CReader slow( ring );
+      CBroadcastRing<int>::CReader tooMany( ring );
+      int value;
+
+      REQUIRE( tooMany.isAttached() == false );
+      REQUIRE( ring.getReaders() == 2 );
+      REQUIRE( fast.frontEntry() == nullptr );
+
+      for( int i1=0; i1<4; i1++ )
+      {
+         REQUIRE( ring.push_back( i1 ) );
+      }
+      REQUIRE( ring.push_back( 4 ) == false );
+      for( int i1=0; i1<4; i1++ )
+      {
+         REQUIRE( fast.pop( value ) );
+         REQUIRE( value == i1 );
+      }
+      REQUIRE( fast.lag() == 0 );
+      REQUIRE( slow.lag() == 4 );
+      REQUIRE( ring.getMaxLag() == 4 );
+      REQUIRE( ring.push_back( 4 ) == false );
+
+      // In place; no copy per reader
+      REQUIRE( *slow.frontEntry() == 0 );
+      REQUIRE( slow.dropFront() );
+      REQUIRE( ring.push_back( 4 ) );
+
+      // Detached readers do not hold the writer back
+      slow.detach();
+      REQUIRE( ring.push_back( 5 ) );
+      REQUIRE( ring.push_back( 6 ) );
+      REQUIRE( fast.pop( value ) );
+      REQUIRE( value == 4 );
+
+      // Readers start with the next entry pushed
+      REQUIRE( tooMany.attach() );
+      REQUIRE( tooMany.isDataAvailable() == false );
+      ring << 7;
+      REQUIRE( tooMany.pop( value ) );
+      REQUIRE( value == 7 );
+      REQUIRE( fast.getOverruns() == 0 );
+   }
+
+   SECTION( "Overwrite" )
+   {
+      CBroadcastRing<int, EBroadcastPolicy::Overwrite> ring( 4, 2 );
+      CBroadcastRing<int, EBroadcastPolicy::Overwrite>::CReader first( ring );
+      CBroadcastRing<int, EBroadcastPolicy::Overwrite>::CReader second( ring );
+      int value;
+
+      for( int i1=0; i1<10; i1++ )
+      {
+         REQUIRE( ring.push_back( i1 ) );
+      }
+      REQUIRE( first.lag() == 4 );
+      for( int i1=6; i1<10; i1++ )
+      {
+         REQUIRE( first.pop( value ) );
+         REQUIRE( value == i1 );
+      }
+      REQUIRE( first.pop( value ) == false );
+      REQUIRE( first.getOverruns() == 6 );
+
+      // Overwritten while being read in place
+      const int* entry=second.frontEntry();
+      REQUIRE( *entry == 6 );
+      ring << 10;
+      REQUIRE( second.dropFront() == false );
+      REQUIRE( second.getOverruns() == 7 );
+      REQUIRE( second.pop( value ) );
+      REQUIRE( value == 7 );
+   }
+
+   SECTION( "Threaded readers" )
+   {
+      static constexpr int READERS = 3;
+      static constexpr int LOOPS = 100000;
+      CBroadcastRing<int> ring( 64, READERS );
+      std::thread readers[ READERS ];
+      int errors[ READERS ];
+      int ready=0;
+
+      for( int i1=0; i1 < READERS; i1++ )
+      {
+         errors[i1]=0;
+         readers[i1]=std::thread( [&ring, &errors, &ready, i1]()
+         {
+            CBroadcastRing<int>::CReader reader( ring );
+            __atomic_add_fetch( &ready, 1, __ATOMIC_SEQ_CST );
+            for( int i2=0; i2 < LOOPS; )
+            {
+               const int* entry=reader.frontEntry();
+               if( !entry )
+               {
+                  std::this_thread::yield();
+                  continue;
+               }
+               errors[i1]+=( *entry != i2 );
+               reader.dropFront();
+               i2++;
+            }
+         } );
+      }
+      while( __atomic_load_n( &ready, __ATOMIC_SEQ_CST ) < READERS )
+      {
+         std::this_thread::yield();
+      }
+
+      for( int i1=0; i1 < LOOPS; )
+      {
+         if( ring.push_back( i1 ) )
+         {
+            i1++;
+         }
+      }
+      for( int i1=0; i1 < READERS; i1++ )
+      {
+         readers[i1].join();
+         REQUIRE( errors[i1] == 0 );
+      }
+   }
+}
+
+
+TEST_CASE( "Statistics ring", "[default]" )
+{
+   SECTION( "Compared to walking the window" )
+   {
+      static constexpr int WINDOW = 7;
+      CStatsRing<short> stats( WINDOW );
+      CRing<short> plain( WINDOW + LEPTO_RING_SPARE_ENTRIES );
+      unsigned int random=1;
+
+      REQUIRE( stats.average() == 0 );
+      REQUIRE( stats.min() == 0 );
+
+      plain.setVolatile( true );
+      for( int i1=0; i1<1000; i1++ )
+      {
+         random=random * 1103515245 + 12345;
+         short value=(short)( ( random >> 16 ) % 2001 ) - 1000;
+
+         stats << value;
+         plain << value;
+
+         REQUIRE( stats.count() == plain.count() );
+         REQUIRE( stats.sum() == plain.sum() );
+         REQUIRE( stats.min() == plain.min() );
+         REQUIRE( stats.max() == plain.max() );
+         REQUIRE( stats.average() == Approx( (double)plain.sum() / plain.count() ) );
+      }
+      REQUIRE( stats.count() == WINDOW );
+
+      short value;
+      REQUIRE( stats.pop( value ) == true );
+      REQUIRE( value == *plain.frontEntry() );
+      stats.clear();
+      REQUIRE( stats.count() == 0 );
+      REQUIRE( stats.sum() == 0 );
+   }
+
+   SECTION( "Variance" )
+   {
+      CStatsRing<float> stats( 4 );
+
+      stats << 100.0f << 2.0f << 4.0f << 4.0f << 4.0f << 6.0f;
+      // Window: 4 4 4 6
+      REQUIRE( stats.average() == Approx( 4.5 ) );
+      REQUIRE( stats.variance() == Approx( 0.75 ) );
+      REQUIRE( stats.min() == 4.0f );
+      REQUIRE( stats.max() == 6.0f );
+
+      // Rounding errors do not pile up
+      for( int i1=0; i1<100000; i1++ )
+      {
+         stats << 0.1f * ( i1 % 10 );
+      }
+      for( int i1=0; i1<4; i1++ )
+      {
+         stats << 1.0f;
+      }
+      REQUIRE( stats.variance() == Approx( 0.0 ).margin( 1e-9 ) );
+   }
+
+   SECTION( "Fixed-point" )
+   {
+      CStatsRing<int, 8> stats( 2 );
+
+      stats << 100 << 1 << 2;
+      // 1.5 in Q.8
+      REQUIRE( stats.average() == 384 );
+      // 0.25 in Q.8
+      REQUIRE( stats.variance() == 64 );
+   }
+
+   SECTION( "Wide samples" )
+   {
+      CStatsRing<unsigned int> stats( 4 );
+
+      stats << 4000000000u << 4000000002u << 4000000000u << 4000000002u;
+      REQUIRE( stats.average() == Approx( 4000000001.0 ) );
+      REQUIRE( stats.variance() == Approx( 1.0 ) );
+
+      CStatsRing<int, 16> fixed( 2 );
+
+      fixed << -2000000000 << 2000000000;
+      REQUIRE( fixed.average() == 0 );
+      REQUIRE( fixed.variance() == (statsWide_t)4000000000000000000LL * 65536 );
+   }
+
+   SECTION( "Read-only window" )
+   {
+      const CStatsRing<short> stats( 3 );
+
+      static_assert( std::is_same<decltype( stats.getEntry( 0 ) ), const short*>::value,
+                     "Entries must not be writable" );
+      static_assert( std::is_const<std::remove_reference<
+                        decltype( *stats.begin() )>::type>::value,
+                     "Entries must not be writable" );
+      REQUIRE( stats.begin() == stats.end() );
+   }
+}
+
+
 /*--- Fin ------------------------------------------------------------------*/
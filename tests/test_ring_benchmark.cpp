@@ -0,0 +1,280 @@
+/**---------------------------------------------------------------------------
+ *
+ * @file       test_ring_benchmark.cpp
+ * @brief      Throughput of the ring variants on the host
+ *
+ *             The benchmarks are hidden and not run by default. Run them
+ *             explicitly:
+ *                lepto_tests "[benchmark]"
+ *
+ * @date       20261017
+ * @author     Maximilian Seesslen <src@seesslen.net>
+ * @copyright  SPDX-License-Identifier: Apache-2.0
+ *
+ *--------------------------------------------------------------------------*/
+
+
+/*--- Includes -------------------------------------------------------------*/
+
+
+#if defined ( CATCH_V3 )
+   #include <catch2/catch_test_macros.hpp>
+#elif defined ( CATCH_V2 )
+   #include <catch2/catch.hpp>
+#elif defined ( CATCH_V1 )
+   #include <catch/catch.hpp>
+#else
+   #error "Either 'catch' or 'catch2' has to be installed"
+#endif
+
+#include <lepto/ring.hpp>
+#include <lepto/ringPow2.hpp>
+#include <chrono>
+#include <thread>
+
+
+/*--- Implementation -------------------------------------------------------*/
+
+
+#define BENCHMARK_LOOPS       ( 20 * 1000 * 1000 )
+
+// Keep the compiler from optimizing the loops away
+static volatile int benchmarkSink;
+
+static double elapsedSeconds( std::chrono::steady_clock::time_point start )
+{
+   return( std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count() );
+}
+
+static void report( const char* name, int operations, double seconds )
+{
+   printf( "%-32s %8.2f Mops/s\n", name, operations / seconds / 1e6 );
+}
+
+// Keep the ring half filled; every loop is one push and one pop
+template <typename R>
+static void benchmarkPushPop( const char* name, R& ring )
+{
+   int sum=0;
+
+   for( int i1=0; i1 < ring.getMaxEntries() / 2; i1++ )
+   {
+      ring.push_back( i1 );
+   }
+
+   auto start=std::chrono::steady_clock::now();
+   for( int i1=0; i1 < BENCHMARK_LOOPS; i1++ )
+   {
+      ring.push_back( i1 );
+      sum += ring.count();
+      sum += *ring.frontEntry();
+      ring.dropFront();
+   }
+   double seconds=elapsedSeconds( start );
+
+   benchmarkSink=sum;
+   report( name, 2 * BENCHMARK_LOOPS, seconds );
+}
+
+
+TEST_CASE( "Ring benchmark modulo vs. mask", "[.benchmark]" )
+{
+   CRing<int> ringModulo( 1024 );
+   CRingPow2<int, 1024> ringMask;
+
+   benchmarkPushPop( "CRing<int>(1024)", ringModulo );
+   benchmarkPushPop( "CRingPow2<int, 1024>", ringMask );
+}
+
+
+TEST_CASE( "Ring benchmark bulk bytes", "[.benchmark]" )
+{
+   static constexpr int CHUNK = 256;
+   CRing<unsigned char> ring( 4096 );
+   unsigned char chunk[ CHUNK ];
+   int sum=0;
+
+   for( int i1=0; i1 < CHUNK; i1++ )
+   {
+      chunk[i1]=i1;
+   }
+
+   auto start=std::chrono::steady_clock::now();
+   for( int i1=0; i1 < BENCHMARK_LOOPS / CHUNK; i1++ )
+   {
+      for( int i2=0; i2 < CHUNK; i2++ )
+      {
+         ring.push_back( chunk[i2] );
+      }
+      for( int i2=0; i2 < CHUNK; i2++ )
+      {
+         sum += ring.pop();
+      }
+   }
+   report( "CRing<uchar> single", 2 * ( BENCHMARK_LOOPS / CHUNK ) * CHUNK,
+           elapsedSeconds( start ) );
+
+   start=std::chrono::steady_clock::now();
+   for( int i1=0; i1 < BENCHMARK_LOOPS / CHUNK; i1++ )
+   {
+      ring.pushBulk( chunk, CHUNK );
+      sum += ring.popBulk( chunk, CHUNK );
+   }
+   report( "CRing<uchar> bulk 256", 2 * ( BENCHMARK_LOOPS / CHUNK ) * CHUNK,
+           elapsedSeconds( start ) );
+
+   benchmarkSink=sum;
+}
+
+
+TEST_CASE( "Ring benchmark aggregation", "[.benchmark]" )
+{
+   static constexpr int ENTRIES = 4096;
+   static constexpr int LOOPS = BENCHMARK_LOOPS / ENTRIES;
+   CRing<short> ring( ENTRIES + 1 );
+   long long sum=0;
+
+   for( int i1=0; i1 < ENTRIES / 2; i1++ )
+   {
+      ring.push_back( 0 );
+      ring.dropFront();
+   }
+   for( int i1=0; i1 < ENTRIES; i1++ )
+   {
+      ring.push_back( i1 );
+   }
+
+   // The way crosssum() used to walk the ring
+   auto start=std::chrono::steady_clock::now();
+   for( int i1=0; i1 < LOOPS; i1++ )
+   {
+      int count=ring.count();
+      for( int i2=0; i2 < count; i2++ )
+      {
+         sum += *ring.getEntry( i2 );
+      }
+   }
+   report( "CRing<short> getEntry() sum", LOOPS * ENTRIES, elapsedSeconds( start ) );
+
+   start=std::chrono::steady_clock::now();
+   for( int i1=0; i1 < LOOPS; i1++ )
+   {
+      sum += ring.sum();
+   }
+   report( "CRing<short> sum()", LOOPS * ENTRIES, elapsedSeconds( start ) );
+
+   benchmarkSink=sum;
+   REQUIRE( sum == 2LL * LOOPS * ( (long long)ENTRIES * ( ENTRIES - 1 ) / 2 ) );
+}
+
+
+// Comparison for CList::find()
+static bool operator <( CList<long long>::CIterator iterator, long long timestamp )
+{
+   return( *iterator < timestamp );
+}
+
+
+TEST_CASE( "Ring benchmark sorted search", "[.benchmark]" )
+{
+   // Time indexed ring: 1M timestamps in microseconds, wrapped in the buffer
+   static constexpr int ENTRIES = 1024 * 1024;
+   static constexpr int LOOKUPS = 2 * 1000 * 1000;
+   CRing<long long> ring( ENTRIES + 1 );
+   long long timestamp=1000000;
+   unsigned int random=1;
+   long long sum=0;
+
+   for( int i1=0; i1 < ENTRIES / 3; i1++ )
+   {
+      ring.push_back( 0 );
+      ring.dropFront();
+   }
+   for( int i1=0; i1 < ENTRIES; i1++ )
+   {
+      timestamp+=1 + ( i1 % 7 );
+      ring.push_back( timestamp );
+   }
+   long long first=*ring.frontEntry();
+   long long range=timestamp - first;
+
+   auto start=std::chrono::steady_clock::now();
+   for( int i1=0; i1 < LOOKUPS; i1++ )
+   {
+      random=random * 1103515245 + 12345;
+      sum+=ring.find( first + (long long)( random % range ) ).realIndex();
+   }
+   report( "find() via CIterator", LOOKUPS, elapsedSeconds( start ) );
+
+   long long found=sum;
+   sum=0;
+   random=1;
+   start=std::chrono::steady_clock::now();
+   for( int i1=0; i1 < LOOKUPS; i1++ )
+   {
+      random=random * 1103515245 + 12345;
+      sum+=ring.at( ring.lower_bound( first + (long long)( random % range ) ) ).realIndex();
+   }
+   report( "lower_bound()", LOOKUPS, elapsedSeconds( start ) );
+
+   benchmarkSink=(int)sum;
+   REQUIRE( sum == found );
+}
+
+
+TEST_CASE( "Ring benchmark threaded", "[.benchmark]" )
+{
+   // Build once with and once without CONFIG_LEPTO_RING_CACHELINE_SEPARATION
+   // to compare the layouts.
+   static constexpr int PRODUCERS = 2;
+   static constexpr int LOOPS = BENCHMARK_LOOPS / 4;
+   CRing<int> ring( 1024 );
+   std::thread producers[ PRODUCERS ];
+   long long sum=0;
+
+   auto start=std::chrono::steady_clock::now();
+   for( int i1=0; i1 < PRODUCERS; i1++ )
+   {
+      producers[i1]=std::thread( [&ring]()
+      {
+         for( int i2=0; i2 < LOOPS; )
+         {
+            ringIndex_t index=ring.tryReserve();
+            if( index == (ringIndex_t)-1 )
+            {
+               std::this_thread::yield();
+               continue;
+            }
+            *ring.reservedEntry( index )=i2++;
+            ring.pushReserved( index );
+         }
+      } );
+   }
+
+   for( int i1=0; i1 < PRODUCERS * LOOPS; )
+   {
+      if( ! ring.isDataAvailable() )
+      {
+         std::this_thread::yield();
+         continue;
+      }
+      sum += *ring.frontEntry();
+      ring.dropFront();
+      i1++;
+   }
+   for( int i1=0; i1 < PRODUCERS; i1++ )
+   {
+      producers[i1].join();
+   }
+
+   #if IS_ENABLED( CONFIG_LEPTO_RING_CACHELINE_SEPARATION )
+      report( "CRing<int> 2:1 separated", 2 * PRODUCERS * LOOPS, elapsedSeconds( start ) );
+   #else
+      report( "CRing<int> 2:1 shared", 2 * PRODUCERS * LOOPS, elapsedSeconds( start ) );
+   #endif
+   benchmarkSink=sum;
+   REQUIRE( sum == (long long)PRODUCERS * LOOPS * ( LOOPS - 1 ) / 2 );
+}
+
+
+/*--- Fin ------------------------------------------------------------------*/
@@ -0,0 +1,125 @@
+/**---------------------------------------------------------------------------
+ *
+ * @file       test_ring_mpmc.cpp
+ * @brief      Test CMpmcRing
+ *
+ * @date       20261017
+ * @author     Maximilian Seesslen <src@seesslen.net>
+ * @copyright  SPDX-License-Identifier: Apache-2.0
+ *
+ *--------------------------------------------------------------------------*/
+
+
+/*--- Includes -------------------------------------------------------------*/
+
+
+#if defined ( CATCH_V3 )
+   #include <catch2/catch_test_macros.hpp>
+#elif defined ( CATCH_V2 )
+   #include <catch2/catch.hpp>
+#elif defined ( CATCH_V1 )
+   #include <catch/catch.hpp>
+#else
+   #error "Either 'catch' or 'catch2' has to be installed"
+#endif
+
+#include <lepto/ringMpmc.hpp>
+#include <test_ring_mpmc.hpp>
+
+
+/*--- Implementation -------------------------------------------------------*/
+
+
+TEST_CASE( "Ring MPMC", "[default]" )
+{
+   SECTION( "Reserve and acquire" )
+   {
+      CMpmcRing<int> ring( 4 );
+      ringIndex_t index;
+      int value;
+
+      REQUIRE( ring.tryAcquire() == (ringIndex_t)-1 );
+      REQUIRE( ring.isDataAvailable() == false );
+
+      // A slow producer only blocks its own slot
+      ringIndex_t slow=ring.tryReserve();
+      REQUIRE( ring.push_back( 2 ) == true );
+      REQUIRE( ring.tryAcquire() == (ringIndex_t)-1 );
+      *ring.reservedEntry( slow )=1;
+      ring.pushReserved( slow );
+
+      REQUIRE( ring.push_back( 3 ) == true );
+      REQUIRE( ring.push_back( 4 ) == true );
+      REQUIRE( ring.push_back( 5 ) == false );
+      REQUIRE( ring.count() == 4 );
+
+      REQUIRE( ( index = ring.tryAcquire() ) != (ringIndex_t)-1 );
+      REQUIRE( *ring.acquiredEntry( index ) == 1 );
+      ring.release( index );
+
+      for( int i1=2; i1<=4; i1++ )
+      {
+         REQUIRE( ring.pop( value ) == true );
+         REQUIRE( value == i1 );
+      }
+      REQUIRE( ring.pop( value ) == false );
+   }
+
+   SECTION( "Wrap" )
+   {
+      CMpmcRing<int> ring( 2 );
+      int value;
+
+      for( int i1=0; i1<1000; i1++ )
+      {
+         REQUIRE( ring.push_back( i1 ) == true );
+         REQUIRE( ring.pop( value ) == true );
+         REQUIRE( value == i1 );
+      }
+   }
+}
+
+
+TEST_CASE( "Ring MPMC threaded", "[default]" )
+{
+   CMpmcRing<SMpmcElement> ring( MPMC_RING_SIZE );
+   bool finished[ MPMC_PRODUCERS ];
+   CMpmcProducer* producers[ MPMC_PRODUCERS ];
+   CMpmcConsumer* consumers[ MPMC_CONSUMERS ];
+   long long sum=0;
+   int loops=0;
+
+   for( int i1=0; i1<MPMC_PRODUCERS; i1++ )
+   {
+      finished[i1]=false;
+      producers[i1]=new CMpmcProducer( i1, finished[i1], ring );
+   }
+   for( int i1=0; i1<MPMC_CONSUMERS; i1++ )
+   {
+      consumers[i1]=new CMpmcConsumer( ring, finished );
+      consumers[i1]->start();
+   }
+   for( int i1=0; i1<MPMC_PRODUCERS; i1++ )
+   {
+      producers[i1]->start();
+   }
+   for( int i1=0; i1<MPMC_PRODUCERS; i1++ )
+   {
+      producers[i1]->wait();
+      delete( producers[i1] );
+   }
+   for( int i1=0; i1<MPMC_CONSUMERS; i1++ )
+   {
+      consumers[i1]->wait();
+      REQUIRE( consumers[i1]->getErrors() == 0 );
+      sum += consumers[i1]->getSum();
+      loops += consumers[i1]->getLoops();
+      delete( consumers[i1] );
+   }
+
+   REQUIRE( loops == MPMC_PRODUCERS * MPMC_PRODUCER_LOOPS );
+   REQUIRE( sum == (long long)MPMC_PRODUCERS * MPMC_PRODUCER_LOOPS * ( MPMC_PRODUCER_LOOPS + 1 ) / 2 );
+}
+
+
+/*--- Fin ------------------------------------------------------------------*/
@@ -0,0 +1,158 @@
+/**---------------------------------------------------------------------------
+ *
+ * @file       test_ring_mpmc.hpp
+ * @brief      Stress test for CMpmcRing with multiple producers and consumers
+ *
+ *             Modelled on test_ring_threaded.hpp. Every producer pushes an
+ *             increasing counter. Every consumer checks that the counters of
+ *             each producer arrive in increasing order. The sum of all
+ *             consumed entries has to match the produced ones.
+ *
+ * @date       20261017
+ * @author     Maximilian Seesslen <src@seesslen.net>
+ * @copyright  SPDX-License-Identifier: Apache-2.0
+ *
+ *--------------------------------------------------------------------------*/
+
+
+/*--- Includes -------------------------------------------------------------*/
+
+
+#include <lepto/lepto.h>
+#include <lepto/ringMpmc.hpp>
+#include <QThread>
+
+#define MPMC_PRODUCER_LOOPS            100000
+#define MPMC_PRODUCERS                 4
+#define MPMC_CONSUMERS                 2
+#define MPMC_RING_SIZE                 64
+
+
+/*--- Declaration ----------------------------------------------------------*/
+
+
+struct SMpmcElement
+{
+   int id;
+   int counter;
+};
+
+
+class CMpmcProducer: public QThread
+{
+   Q_OBJECT
+
+   int m_id;
+   bool& m_finished;
+   CMpmcRing<SMpmcElement>& m_ring;
+
+public:
+   CMpmcProducer( int id, bool& finished, CMpmcRing<SMpmcElement>& ring )
+      :m_id(id)
+      ,m_finished(finished)
+      ,m_ring(ring)
+   {
+   }
+   void run() override
+   {
+      int counter=0;
+
+      while( counter < MPMC_PRODUCER_LOOPS )
+      {
+         ringIndex_t index;
+         if( ( index = m_ring.tryReserve() ) != (ringIndex_t)-1 )
+         {
+            counter++;
+            *m_ring.reservedEntry( index ) = SMpmcElement{ m_id, counter };
+            m_ring.pushReserved( index );
+         }
+         else
+         {
+            QThread::yieldCurrentThread();
+         }
+      }
+      __atomic_store_n( &m_finished, true, __ATOMIC_RELEASE );
+   }
+};
+
+
+class CMpmcConsumer: public QThread
+{
+   Q_OBJECT
+
+   private:
+      CMpmcRing<SMpmcElement>& m_ring;
+      bool* m_producersFinished;
+      int m_counters[ MPMC_PRODUCERS ];
+      long long m_sum=0;
+      int m_loops=0;
+      int m_errors=0;
+
+      bool allProducerFinished()
+      {
+         for(int i1=0; i1<MPMC_PRODUCERS; i1++)
+         {
+            if( ! __atomic_load_n( &m_producersFinished[i1], __ATOMIC_ACQUIRE ) )
+            {
+               return( false );
+            }
+         }
+         return( true );
+      }
+
+   public:
+      CMpmcConsumer( CMpmcRing<SMpmcElement>& ring, bool* producersFinished )
+         :m_ring( ring )
+         ,m_producersFinished( producersFinished )
+      {
+         for (int i1 = 0; i1 < MPMC_PRODUCERS; ++i1)
+         {
+            m_counters[i1]=0;
+         }
+      }
+      void run() override
+      {
+         while( true )
+         {
+            // Check before popping; otherwise the last entries could be lost
+            bool finished=allProducerFinished();
+            SMpmcElement entry;
+
+            if( m_ring.pop( entry ) )
+            {
+               if( entry.counter <= m_counters[ entry.id ] )
+               {
+                  lInfo("Producer %d: got %d after %d", entry.id, entry.counter
+                        , m_counters[ entry.id ] );
+                  m_errors++;
+               }
+               m_counters[ entry.id ] = entry.counter;
+               m_sum += entry.counter;
+               m_loops++;
+            }
+            else if( finished )
+            {
+               break;
+            }
+            else
+            {
+               QThread::yieldCurrentThread();
+            }
+         }
+      }
+      long long getSum()
+      {
+         return( m_sum );
+      }
+      int getLoops()
+      {
+         return( m_loops );
+      }
+      int getErrors()
+      {
+         return( m_errors );
+      }
+};
+
+
+/*--- Fin ------------------------------------------------------------------*/
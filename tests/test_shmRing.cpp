@@ -0,0 +1,194 @@
+/**---------------------------------------------------------------------------
+ *
+ * @file       test_shmRing.cpp
+ * @brief      Test CShmRing between forked processes
+ *
+ * @date       20261017
+ * @author     Maximilian Seesslen <src@seesslen.net>
+ * @copyright  SPDX-License-Identifier: Apache-2.0
+ *
+ *--------------------------------------------------------------------------*/
+
+
+/*--- Includes -------------------------------------------------------------*/
+
+
+#if defined ( CATCH_V3 )
+   #include <catch2/catch_test_macros.hpp>
+#elif defined ( CATCH_V2 )
+   #include <catch2/catch.hpp>
+#elif defined ( CATCH_V1 )
+   #include <catch/catch.hpp>
+#else
+   #error "Either 'catch' or 'catch2' has to be installed"
+#endif
+
+#include <lepto/shmRing.hpp>
+
+#if defined( __linux__ )
+
+#include <sys/wait.h>
+#include <unistd.h>
+#include <stdio.h>
+#include <sched.h>
+
+
+/*--- Implementation -------------------------------------------------------*/
+
+
+struct SElement
+{
+   int producer;
+   int sequence;
+   char payload[ 24 ];
+};
+
+static constexpr int LOOPS = 20000;
+
+
+// Runs in the child; leaves with _exit() to skip the destructors of the
+// parent's objects
+static void produce( CShmRing<SElement>& ring, int producer )
+{
+   for( int i1=0; i1<LOOPS; )
+   {
+      ringIndex_t index=ring.tryReserve();
+      if( index == (ringIndex_t)-1 )
+      {
+         sched_yield();
+         continue;
+      }
+      SElement* element=ring.reservedEntry( index );
+      element->producer=producer;
+      element->sequence=i1++;
+      snprintf( element->payload, sizeof( element->payload ), "%d", element->sequence );
+      ring.pushReserved( index );
+   }
+   _exit( 0 );
+}
+
+
+static int consume( CShmRing<SElement>& ring, int producers )
+{
+   int last[ 4 ]={ -1, -1, -1, -1 };
+   int errors=0;
+   char expected[ 24 ];
+
+   for( int i1=0; i1 < producers * LOOPS; )
+   {
+      SElement* element=ring.frontEntry();
+      if( ! element )
+      {
+         sched_yield();
+         continue;
+      }
+      snprintf( expected, sizeof( expected ), "%d", element->sequence );
+      if( ( element->sequence != last[ element->producer ] + 1 )
+          || strcmp( expected, element->payload ) )
+      {
+         errors++;
+      }
+      last[ element->producer ]=element->sequence;
+      ring.dropFront();
+      i1++;
+   }
+
+   return( errors );
+}
+
+
+static bool waitForChildren( int children )
+{
+   bool success=true;
+   int status;
+
+   for( int i1=0; i1<children; i1++ )
+   {
+      wait( &status );
+      success=success && WIFEXITED( status ) && ( WEXITSTATUS( status ) == 0 );
+   }
+   return( success );
+}
+
+
+TEST_CASE( "Shared memory ring", "[default]" )
+{
+   SECTION( "Anonymous and forked" )
+   {
+      CShmRing<SElement> ring;
+
+      REQUIRE( ring.create( nullptr, 64 ) == true );
+      REQUIRE( ring.getMaxEntries() == 64 );
+      REQUIRE( ring.isDataAvailable() == false );
+
+      if( fork() == 0 )
+      {
+         produce( ring, 0 );
+      }
+      REQUIRE( consume( ring, 1 ) == 0 );
+      REQUIRE( waitForChildren( 1 ) );
+      REQUIRE( ring.count() == 0 );
+   }
+
+   SECTION( "Drop while a producer is busy" )
+   {
+      CShmRing<SElement> ring;
+      SElement element{ 0, 7, "7" };
+
+      REQUIRE( ring.create( nullptr, 8 ) == true );
+      REQUIRE( ring.push_back( element ) );
+      REQUIRE( ring.frontEntry()->sequence == 7 );
+
+      // Another process is in the middle of pushing
+      ringIndex_t index=ring.tryReserve();
+      REQUIRE( ring.frontEntry() == nullptr );
+      ring.dropFront();
+      REQUIRE( ring.count() == 1 );
+
+      ring.pushReserved( index );
+      REQUIRE( ring.frontEntry() != nullptr );
+   }
+
+   SECTION( "Named with attaching producers" )
+   {
+      static constexpr int PRODUCERS = 3;
+      char name[ 32 ];
+      CShmRing<SElement> ring;
+
+      snprintf( name, sizeof( name ), "/lepto_test_%d", (int)getpid() );
+      CShmMapping::unlink( name );
+      REQUIRE( ring.create( name, 100 ) == true );
+
+      // Exists already
+      CShmRing<SElement> second;
+      REQUIRE( second.create( name, 100 ) == false );
+      // Wrong type
+      CShmRing<int> other;
+      REQUIRE( other.attach( name ) == false );
+
+      for( int i1=0; i1<PRODUCERS; i1++ )
+      {
+         if( fork() == 0 )
+         {
+            CShmRing<SElement> attached;
+            if( ! attached.attach( name ) )
+            {
+               _exit( 1 );
+            }
+            produce( attached, i1 );
+         }
+      }
+      REQUIRE( consume( ring, PRODUCERS ) == 0 );
+      REQUIRE( waitForChildren( PRODUCERS ) );
+
+      ring.detach();
+      REQUIRE( ring.isAttached() == false );
+      // The creator unlinked it
+      REQUIRE( second.attach( name ) == false );
+   }
+}
+
+#endif // ? __linux__
+
+
+/*--- Fin ------------------------------------------------------------------*/